@@ -0,0 +1,25 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+// std::min 按引用取参数，需要类外定义
+const size_t Arena::kFirstChunk;
+const size_t Arena::kMaxChunk;
+
+void Arena::grow(size_t min_size) {
+    const size_t size = std::max(m_next_chunk, min_size);
+    char* chunk = static_cast<char*>(std::malloc(size));
+    if (!chunk) throw std::bad_alloc();
+    m_chunks.push_back(chunk);
+    m_cur = chunk;
+    m_end = chunk + size;
+    m_next_chunk = std::min(m_next_chunk * 2, kMaxChunk);
+}
+
+void Arena::release() {
+    for (char* chunk : m_chunks) std::free(chunk);
+    m_chunks.clear();
+    m_cur = m_end = nullptr;
+    m_next_chunk = kFirstChunk;
+    m_bytes = 0;
+}
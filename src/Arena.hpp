@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class Arena
+ * @brief 分块的指针碰撞（bump pointer）分配器
+ *
+ * 从当前块里顺序切出内存，块用完时再向系统要一块更大的（从 kFirstChunk 起翻倍，
+ * 最大 kMaxChunk；超过一块大小的请求单独成块）。单个对象不能释放，
+ * release() 或析构时一次性归还所有块，并且不调用对象的析构函数——
+ * 放进来的对象（AST 节点等）不能持有需要析构的成员，数组请用 ArenaVector。
+ * 每次编译用自己的 Arena，编译结束（或 AST 用完）时整体释放。
+ */
+class Arena {
+public:
+    Arena() = default;
+    ~Arena() { release(); }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(m_cur) + align - 1) & ~(uintptr_t)(align - 1);
+        if (p + size > reinterpret_cast<uintptr_t>(m_end)) {
+            grow(size + align);
+            p = (reinterpret_cast<uintptr_t>(m_cur) + align - 1) & ~(uintptr_t)(align - 1);
+        }
+        m_cur = reinterpret_cast<char*>(p + size);
+        m_bytes += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    template<class T, class... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template<class T>
+    T* allocateArray(size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "arena arrays hold trivially copyable elements");
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    // 归还所有块；之前分配的对象全部失效
+    void release();
+
+    size_t bytesAllocated() const { return m_bytes; }      // 分配给对象的字节数
+    size_t chunkCount() const { return m_chunks.size(); }  // 向系统申请的次数
+
+private:
+    static const size_t kFirstChunk = 64 * 1024;
+    static const size_t kMaxChunk = 4 * 1024 * 1024;
+
+    void grow(size_t min_size);
+
+    std::vector<char*> m_chunks;
+    char* m_cur = nullptr;
+    char* m_end = nullptr;
+    size_t m_next_chunk = kFirstChunk;
+    size_t m_bytes = 0;
+};
+
+/**
+ * @class ArenaVector
+ * @brief 存储在 Arena 里的可增长数组
+ *
+ * 只保存指针和长度，本身可以按值复制、放进 Bison 的 %union；增长时在 Arena 里
+ * 另开一段两倍大的空间并复制过去，旧空间随 Arena 一起释放（浪费不超过最终大小）。
+ * 元素必须是可平凡复制的类型（AST 里都是指针）。
+ */
+template<class T>
+class ArenaVector {
+public:
+    void push_back(Arena& arena, const T& value) {
+        if (m_size == m_capacity) {
+            const uint32_t capacity = m_capacity ? m_capacity * 2 : 4;
+            T* data = arena.allocateArray<T>(capacity);
+            if (m_size) std::memcpy(data, m_data, sizeof(T) * m_size);
+            m_data = data;
+            m_capacity = capacity;
+        }
+        m_data[m_size++] = value;
+    }
+
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    T& operator[](size_t i) const { return m_data[i]; }
+
+private:
+    T* m_data = nullptr;
+    uint32_t m_size = 0;
+    uint32_t m_capacity = 0;
+};
@@ -0,0 +1,267 @@
+#include "CFG.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+int reachable_end(const BasicBlock& bb) {
+    for (size_t i = 0; i < bb.instructions.size(); ++i) {
+        if (is_terminator(bb.instructions[i])) return (int)i + 1;
+    }
+    return (int)bb.instructions.size();
+}
+
+int find_block(const FunctionIR& func, Symbol label) {
+    auto it = func.cfg.label_index.find(label);
+    return it == func.cfg.label_index.end() ? -1 : it->second;
+}
+
+Symbol new_block_label(FunctionIR& func, const std::string& hint) {
+    return Symbol::intern("." + hint + std::to_string(func.next_label++) + "_" + func.name);
+}
+
+namespace {
+
+void add_edge(FunctionIR& func, int from, int to) {
+    auto& succs = func.blocks[from].succs;
+    for (int s : succs) if (s == to) return;
+    succs.push_back(to);
+    func.blocks[to].preds.push_back(from);
+}
+
+// 非递归 DFS 求逆后序
+void compute_rpo(FunctionIR& func) {
+    const int n = (int)func.blocks.size();
+    CFGInfo& cfg = func.cfg;
+    cfg.rpo.clear();
+    cfg.rpo_index.assign(n, -1);
+    if (n == 0) return;
+
+    std::vector<int> postorder;
+    std::vector<bool> visited(n, false);
+    std::vector<std::pair<int, size_t>> stack; // (块, 下一个要访问的后继下标)
+    stack.push_back({ 0, 0 });
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        const auto& succs = func.blocks[top.first].succs;
+        if (top.second < succs.size()) {
+            int s = succs[top.second++];
+            if (!visited[s]) {
+                visited[s] = true;
+                stack.push_back({ s, 0 });
+            }
+        }
+        else {
+            postorder.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    cfg.rpo.assign(postorder.rbegin(), postorder.rend());
+    for (size_t i = 0; i < cfg.rpo.size(); ++i) cfg.rpo_index[cfg.rpo[i]] = (int)i;
+}
+
+// Cooper, Harvey & Kennedy: "A Simple, Fast Dominance Algorithm"
+void compute_dominators(FunctionIR& func) {
+    const int n = (int)func.blocks.size();
+    CFGInfo& cfg = func.cfg;
+    cfg.idom.assign(n, -1);
+    cfg.dom_children.assign(n, {});
+    cfg.dom_pre.assign(n, -1);
+    cfg.dom_post.assign(n, -1);
+    if (n == 0) return;
+
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (cfg.rpo_index[a] > cfg.rpo_index[b]) a = cfg.idom[a];
+            while (cfg.rpo_index[b] > cfg.rpo_index[a]) b = cfg.idom[b];
+        }
+        return a;
+    };
+
+    cfg.idom[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < cfg.rpo.size(); ++i) {
+            int b = cfg.rpo[i];
+            int new_idom = -1;
+            for (int p : func.blocks[b].preds) {
+                if (cfg.idom[p] < 0) continue; // 尚未处理或不可达
+                new_idom = new_idom < 0 ? p : intersect(p, new_idom);
+            }
+            if (new_idom >= 0 && cfg.idom[b] != new_idom) {
+                cfg.idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    for (int b : cfg.rpo) {
+        if (b != 0) cfg.dom_children[cfg.idom[b]].push_back(b);
+    }
+
+    // 支配树的先序/后序编号
+    int counter = 0;
+    std::vector<std::pair<int, size_t>> stack;
+    stack.push_back({ 0, 0 });
+    cfg.dom_pre[0] = counter++;
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        const auto& children = cfg.dom_children[top.first];
+        if (top.second < children.size()) {
+            int c = children[top.second++];
+            cfg.dom_pre[c] = counter++;
+            stack.push_back({ c, 0 });
+        }
+        else {
+            cfg.dom_post[top.first] = counter++;
+            stack.pop_back();
+        }
+    }
+}
+
+} // namespace
+
+void build_cfg(FunctionIR& func) {
+    const int n = (int)func.blocks.size();
+    CFGInfo& cfg = func.cfg;
+    cfg.label_index.clear();
+    cfg.exits.clear();
+    for (int b = 0; b < n; ++b) {
+        BasicBlock& bb = func.blocks[b];
+        bb.id = b;
+        bb.preds.clear();
+        bb.succs.clear();
+        cfg.label_index[bb.label] = b;
+    }
+
+    for (int b = 0; b < n; ++b) {
+        const auto& instrs = func.blocks[b].instructions;
+        const int end = reachable_end(func.blocks[b]);
+        for (int i = 0; i < end; ++i) {
+            if (const Symbol* target = jump_target(instrs[i])) {
+                int t = find_block(func, *target);
+                if (t >= 0) add_edge(func, b, t);
+            }
+        }
+        if (end > 0 && is_return(instrs[end - 1])) {
+            cfg.exits.push_back(b);
+        }
+        else if (end == 0 || instrs[end - 1].opcode != Instruction::JUMP) {
+            if (b + 1 < n) add_edge(func, b, b + 1); // 落入下一块
+            else cfg.exits.push_back(b);             // 从函数末尾落出
+        }
+    }
+
+    compute_rpo(func);
+    compute_dominators(func);
+}
+
+static bool is_cond_jump(const Instruction& instr) {
+    return instr.opcode == Instruction::JUMP_IF_ZERO || instr.opcode == Instruction::JUMP_IF_NZERO;
+}
+
+bool canonicalize_blocks(FunctionIR& func) {
+    bool changed = false;
+    std::vector<BasicBlock> blocks;
+    blocks.reserve(func.blocks.size());
+
+    if (!func.blocks.empty()) {
+        const Symbol entry = func.blocks[0].label;
+        bool entry_targeted = false;
+        for (const auto& bb : func.blocks) {
+            for (const auto& instr : bb.instructions) {
+                const Symbol* target = jump_target(instr);
+                if (target && *target == entry) entry_targeted = true;
+            }
+        }
+        if (entry_targeted) {
+            BasicBlock new_entry;
+            new_entry.label = new_block_label(func, "entry");
+            blocks.push_back(std::move(new_entry));
+            changed = true;
+        }
+    }
+
+    for (auto& bb : func.blocks) {
+        const int end = reachable_end(bb);
+        if (end < (int)bb.instructions.size()) changed = true;
+
+        BasicBlock cur;
+        cur.label = bb.label;
+        for (int i = 0; i < end; ++i) {
+            cur.instructions.push_back(std::move(bb.instructions[i]));
+            if (is_cond_jump(cur.instructions.back()) && i + 1 < end) {
+                blocks.push_back(std::move(cur));
+                cur = BasicBlock();
+                cur.label = new_block_label(func, "split");
+                changed = true;
+            }
+        }
+        blocks.push_back(std::move(cur));
+    }
+
+    // 跳到落入块的条件跳转没有意义
+    for (size_t b = 0; b + 1 < blocks.size(); ++b) {
+        auto& instrs = blocks[b].instructions;
+        if (!instrs.empty() && is_cond_jump(instrs.back()) && instrs.back().arg2.name == blocks[b + 1].label) {
+            instrs.pop_back();
+            changed = true;
+        }
+    }
+
+    func.blocks = std::move(blocks);
+    build_cfg(func);
+    return changed;
+}
+
+bool remove_unreachable_blocks(FunctionIR& func) {
+    std::vector<BasicBlock> blocks;
+    std::unordered_set<Symbol> removed;
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        if (is_reachable(func, b)) blocks.push_back(std::move(func.blocks[b]));
+        else removed.insert(func.blocks[b].label);
+    }
+    if (removed.empty()) {
+        func.blocks = std::move(blocks);
+        return false;
+    }
+
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        auto& instrs = blocks[b].instructions;
+        for (auto& instr : instrs) {
+            if (instr.opcode != Instruction::PHI) continue;
+            auto& args = instr.phi_args;
+            args.erase(std::remove_if(args.begin(), args.end(), [&](const Instruction::PhiArg& arg) {
+                return removed.count(arg.block) > 0;
+            }), args.end());
+        }
+        // 删块之后条件跳转的目标可能正好是下一块
+        if (b + 1 < blocks.size() && !instrs.empty() && is_cond_jump(instrs.back()) &&
+            instrs.back().arg2.name == blocks[b + 1].label) {
+            instrs.pop_back();
+        }
+    }
+    func.blocks = std::move(blocks);
+    build_cfg(func);
+    return true;
+}
+
+// Cooper, Harvey & Kennedy 的支配边界算法：从汇合点的每个前驱沿支配树向上走到汇合点的 idom
+std::vector<std::vector<int>> dominance_frontiers(const FunctionIR& func) {
+    const CFGInfo& cfg = func.cfg;
+    std::vector<std::vector<int>> df(func.blocks.size());
+    for (int b : cfg.rpo) {
+        const auto& preds = func.blocks[b].preds;
+        if (preds.size() < 2) continue;
+        for (int p : preds) {
+            if (!is_reachable(func, p)) continue;
+            int runner = p;
+            while (runner != cfg.idom[b]) {
+                auto& frontier = df[runner];
+                if (std::find(frontier.begin(), frontier.end(), b) == frontier.end()) frontier.push_back(b);
+                runner = cfg.idom[runner];
+            }
+        }
+    }
+    return df;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ir.hpp"
+#include <string>
+
+// --- 控制流图 ---
+// build_cfg 根据跳转指令和块的布局顺序（没有以 JUMP/RET 结束的块落入下一块）
+// 计算每个块的 id、前驱/后继，以及逆后序、支配树和出口块。
+// IRGenerator 为每个函数建立一次；修改了控制流（增删块、改跳转目标、调整块顺序）
+// 的遍负责重新调用，FunctionPass 在报告修改后也会重建一次。
+void build_cfg(FunctionIR& func);
+
+// 块中可执行部分的长度：第一条无条件跳转/RET 之后的指令永远不会执行
+int reachable_end(const BasicBlock& bb);
+
+// 按标签查找块 id，找不到返回 -1
+int find_block(const FunctionIR& func, Symbol label);
+
+// 为优化遍新建的块生成一个模块内唯一的标签，hint 说明块的用途
+Symbol new_block_label(FunctionIR& func, const std::string& hint);
+
+// 把函数整理成规范形式并重建控制流图：
+//   - 删除无条件跳转/RET 之后的死指令；
+//   - 在块中间的条件跳转之后切开，使跳转只出现在块的末尾；
+//   - 删除目标就是落入块的条件跳转；
+//   - 入口块若是跳转目标，则在前面插入一个空的入口块。
+// 之后每个块最多以“条件跳转（另一条边落入下一块）”或“JUMP/RET”结束，
+// 边上的代码可以直接放在前驱末尾或拆分出的新块里。返回是否修改了 IR。
+bool canonicalize_blocks(FunctionIR& func);
+
+// 删除从入口不可达的块（SSA 形式下同时删掉 PHI 中来自这些块的实参），并重建控制流图。
+// 返回是否删除了块。
+bool remove_unreachable_blocks(FunctionIR& func);
+
+// 每个可达块的支配边界
+std::vector<std::vector<int>> dominance_frontiers(const FunctionIR& func);
+
+inline bool is_reachable(const FunctionIR& func, int b) {
+    return func.cfg.rpo_index[b] >= 0;
+}
+
+// a 是否支配 b（a == b 也算）；两者都必须可达
+inline bool dominates(const FunctionIR& func, int a, int b) {
+    return func.cfg.dom_pre[a] <= func.cfg.dom_pre[b] && func.cfg.dom_post[b] <= func.cfg.dom_post[a];
+}
@@ -1,185 +1,496 @@
 #include "CodeGenerator.hpp"
-#include "SpillEverythingAllocator.hpp" // ʵ
+#include "SpillEverythingAllocator.hpp" // 包含具体实现
+#include "LinearScanAllocator.hpp"
+#include "GraphColoringAllocator.hpp"
+#include "Liveness.hpp"
+#include "StrengthReduction.hpp"
 #include <iostream>
 #include <stdexcept>
 
-// ڹ캯ѡ
-CodeGenerator::CodeGenerator() {
-    // δ뻻ʱֻ޸һУ
-    m_allocator = std::make_unique<SpillEverythingAllocator>();
+// 在构造函数中选择策略
+CodeGenerator::CodeGenerator(AllocatorKind kind) {
+    switch (kind) {
+    case AllocatorKind::SpillEverything:
+        m_allocator = std::make_unique<SpillEverythingAllocator>();
+        break;
+    case AllocatorKind::LinearScan:
+        m_allocator = std::make_unique<LinearScanAllocator>();
+        break;
+    case AllocatorKind::GraphColoring:
+        m_allocator = std::make_unique<GraphColoringAllocator>();
+        break;
+    }
 }
 
-// generate_function ֻ̿
-void CodeGenerator::generate_function(const FunctionIR& func) {
-    // 1. ׼׶
-    m_allocator->prepare(func);
+// generate_function 现在只负责流程控制
+void CodeGenerator::generate_function(const FunctionIR& input) {
+    // 0. 寄存器分配之前的调度在一份副本上进行，之后的各步都看调度后的顺序
+    FunctionIR scheduled;
+    if (m_schedule_pre_ra) {
+        scheduled = input;
+        m_scheduler.scheduleIR(scheduled);
+    }
+    const FunctionIR& func = m_schedule_pre_ra ? scheduled : input;
+
+    if (func.in_ssa) {
+        throw std::runtime_error("CodeGenerator Error: function '" + func.name + "' is still in SSA form.");
+    }
+
+    // 1. 准备阶段：先找出被模式吸收的值，分配器不给它们寄存器和栈槽
+    count_uses(func);
+    find_folded_values(func);
+    m_allocator->prepare(func, m_folded);
+    m_pending_params.clear();
+    m_func = MachineFunction();
+    m_func.name = func.name;
+    m_func.blocks.emplace_back();
 
-    // 2. 
-    m_output << m_allocator->getPrologue();
+    // 2. 生成序言
+    m_allocator->emitPrologue(out());
 
-    // 3. ָ
-    for (const auto& bb : func.blocks) {
+    // 3. 逐条生成指令，能匹配模式的几条一起生成；分支/跳转/返回之后另起一个块
+    for (size_t b = 0; b < func.blocks.size(); ++b) {
+        const auto& bb = func.blocks[b];
         if (!bb.label.empty()) {
-            m_output << bb.label << ":\n";
+            start_block(m_func.internLabel(bb.label));
         }
-        for (const auto& instr : bb.instructions) {
-            generate_instruction(instr);
+        for (size_t i = 0; i < bb.instructions.size();) {
+            size_t n = select_pattern(func, b, i);
+            if (n == 0) {
+                generate_instruction(bb.instructions[i]);
+                n = 1;
+            }
+            i += n;
+            if (!out().empty() && out().back().isTerminator()) start_block(-1);
         }
     }
+
+    // 4. 窥孔优化（以函数为单位，不会跨函数合并），然后调度，最后统一打印。
+    //    窥孔的规则要看相邻的指令，所以放在调度之前
+    if (m_peephole_enabled) m_peephole.run(m_func);
+    if (m_schedule_post_ra) m_scheduler.scheduleMachine(m_func);
+    print_machine_function(m_func, m_output);
 }
 
-// generate_instruction ڵ m_allocator ô
-void CodeGenerator::generate_instruction(const Instruction& instr) {
-    switch (instr.opcode) {
-    case Instruction::ADD: case Instruction::SUB: case Instruction::MUL: case Instruction::DIV: case Instruction::MOD: {
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->loadOperand(instr.arg2, "t1");
-        std::string op_str;
-        if (instr.opcode == Instruction::ADD) op_str = "add";
-        if (instr.opcode == Instruction::SUB) op_str = "sub";
-        if (instr.opcode == Instruction::MUL) op_str = "mul";
-        if (instr.opcode == Instruction::DIV) op_str = "div";
-        if (instr.opcode == Instruction::MOD) op_str = "rem";
-        m_output << "  " << op_str << " t2, t0, t1\n";
-        m_output << m_allocator->storeOperand(instr.result, "t2");
+void CodeGenerator::start_block(int label) {
+    MachineBasicBlock& cur = m_func.blocks.back();
+    if (cur.instrs.empty() && cur.label < 0) {
+        cur.label = label;
+        return;
+    }
+    m_func.blocks.emplace_back();
+    m_func.blocks.back().label = label;
+}
+
+void CodeGenerator::count_uses(const FunctionIR& func) {
+    m_use_count.clear();
+    m_block_of_label.clear();
+    for (size_t b = 0; b < func.blocks.size(); ++b) {
+        if (!func.blocks[b].label.empty()) m_block_of_label[func.blocks[b].label] = b;
+        for (const auto& instr : func.blocks[b].instructions) {
+            for_each_use(instr, [&](const Operand& op) { m_use_count[Liveness::keyOf(op)]++; });
+        }
+    }
+}
+
+// 值在整个函数里只被用了一次：这次使用之后它就死了
+bool CodeGenerator::is_single_use(const Operand& op) const {
+    if (!is_value(op)) return false;
+    auto it = m_use_count.find(Liveness::keyOf(op));
+    return it != m_use_count.end() && it->second == 1;
+}
+
+// 能直接放进 I 型指令的常量
+static bool imm_operand(const Operand& op, int& value) {
+    if (op.kind != Operand::CONST || !fits_imm12(op.value)) return false;
+    value = op.value;
+    return true;
+}
+
+static bool is_compare(Instruction::OpCode op) {
+    return op == Instruction::EQ || op == Instruction::NEQ || op == Instruction::LT ||
+        op == Instruction::GT || op == Instruction::LE || op == Instruction::GE;
+}
+
+CodeGenerator::Pattern CodeGenerator::match_pattern(const FunctionIR& func, size_t b, size_t i) const {
+    const auto& instrs = func.blocks[b].instructions;
+    const Instruction& instr = instrs[i];
+    Pattern p;
+
+    // 1. 比较（或逻辑非）的结果只给紧随其后的条件跳转用：合成一条比较分支，结果不必写出
+    if (i + 1 < instrs.size()) {
+        const Instruction& br = instrs[i + 1];
+        const bool is_branch = br.opcode == Instruction::JUMP_IF_ZERO || br.opcode == Instruction::JUMP_IF_NZERO;
+        if (is_branch && same_value(br.arg1, instr.result) && is_single_use(instr.result)
+            && (is_compare(instr.opcode) || instr.opcode == Instruction::NOT)) {
+            p.kind = instr.opcode == Instruction::NOT ? Pattern::NOT_BRANCH : Pattern::COMPARE_BRANCH;
+            p.length = 2;
+            p.branch_if_true = br.opcode == Instruction::JUMP_IF_NZERO;
+            p.dest = br.arg2.name;
+            return p;
+        }
+    }
+
+    // 2. 短路求值的结果块：x = 常量，再到（跳到或落入）一个立刻检查 x 的块。
+    //    这条路径上跳转的方向已经确定，直接跳到最终目标，x 也不必写出
+    if (instr.opcode == Instruction::ASSIGN && instr.arg1.kind == Operand::CONST && is_single_use(instr.result)) {
+        size_t target_block = func.blocks.size();
+        if (i + 1 == instrs.size() && b + 1 < func.blocks.size()) {
+            target_block = b + 1;
+        }
+        else if (i + 2 == instrs.size() && instrs[i + 1].opcode == Instruction::JUMP) {
+            auto it = m_block_of_label.find(instrs[i + 1].arg1.name);
+            if (it != m_block_of_label.end()) target_block = it->second;
+        }
+        if (target_block < func.blocks.size() && !func.blocks[target_block].instructions.empty()) {
+            const auto& test_block = func.blocks[target_block].instructions;
+            const Instruction& br = test_block[0];
+            const bool is_branch = br.opcode == Instruction::JUMP_IF_ZERO || br.opcode == Instruction::JUMP_IF_NZERO;
+            if (is_branch && same_value(br.arg1, instr.result)) {
+                const bool taken = (br.opcode == Instruction::JUMP_IF_ZERO) == (instr.arg1.value == 0);
+                Symbol dest;
+                if (taken) dest = br.arg2.name;
+                else if (test_block.size() > 1 && test_block[1].opcode == Instruction::JUMP) dest = test_block[1].arg1.name;
+                else if (test_block.size() == 1 && target_block + 1 < func.blocks.size()) dest = func.blocks[target_block + 1].label;
+                if (!dest.empty()) {
+                    p.kind = Pattern::CONST_JUMP;
+                    p.length = instrs.size() - i;
+                    p.dest = dest;
+                    return p;
+                }
+            }
+        }
+    }
+    return p;
+}
+
+size_t CodeGenerator::select_pattern(const FunctionIR& func, size_t b, size_t i) {
+    const Instruction& instr = func.blocks[b].instructions[i];
+    const Pattern p = match_pattern(func, b, i);
+    switch (p.kind) {
+    case Pattern::NONE:
+        return 0;
+    case Pattern::COMPARE_BRANCH:
+        emit_compare_branch(instr, p.branch_if_true, p.dest);
+        break;
+    case Pattern::NOT_BRANCH: {
+        PhysReg r1 = use_reg(instr.arg1, T0);
+        emit(p.branch_if_true ? MachineInstr::BEQZ : MachineInstr::BNEZ, MachineOperand::r(r1),
+            MachineOperand::label(m_func.internLabel(p.dest)));
         break;
     }
-    case Instruction::NOT: { // ߼
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << "  seqz t0, t0\n"; //  t0 Ϊ 0 t0=1 t0=0
-        m_output << m_allocator->storeOperand(instr.result, "t0");
+    case Pattern::CONST_JUMP:
+        emit(MachineInstr::J, MachineOperand::label(m_func.internLabel(p.dest)));
         break;
     }
+    return p.length;
+}
 
-    case Instruction::EQ: { //  ==
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->loadOperand(instr.arg2, "t1");
-        m_output << "  sub t2, t0, t1\n";
-        m_output << "  seqz t2, t2\n"; //  t2 (ֵ) Ϊ 0 t2=1
-        m_output << m_allocator->storeOperand(instr.result, "t2");
-        break;
+// 找出每次定值都被模式吸收的值：它们从不写出，寄存器分配器可以不管。
+// 只吸收了一部分定值的值照常分配（其余路径要写它），参数在入口处有定值，也不算。
+// 扫描的步进与 generate_function 相同，被模式跳过的指令不会单独匹配
+void CodeGenerator::find_folded_values(const FunctionIR& func) {
+    std::unordered_map<ValueKey, int> defs, fused;
+    for (const auto& param : func.params) defs[value_key({ Operand::VAR, param.name })]++;
+    for (size_t b = 0; b < func.blocks.size(); ++b) {
+        const auto& instrs = func.blocks[b].instructions;
+        for (size_t i = 0; i < instrs.size();) {
+            const Pattern p = match_pattern(func, b, i);
+            if (p.kind != Pattern::NONE) fused[value_key(instrs[i].result)]++;
+            const size_t n = p.kind == Pattern::NONE ? 1 : p.length;
+            for (size_t k = i; k < i + n; ++k) {
+                if (const Operand* def = instr_def(instrs[k])) defs[value_key(*def)]++;
+            }
+            i += n;
+        }
+    }
+    m_folded.clear();
+    for (const auto& f : fused) {
+        if (defs[f.first] == f.second) m_folded.insert(f.first);
     }
+}
 
-    case Instruction::NEQ: { //  !=
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->loadOperand(instr.arg2, "t1");
-        m_output << "  sub t2, t0, t1\n";
-        m_output << "  snez t2, t2\n"; //  t2 (ֵ) Ϊ 0 t2=1
-        m_output << m_allocator->storeOperand(instr.result, "t2");
-        break;
+// 比较 cmp 的结果为真（branch_if_true）或为假时跳到 label
+void CodeGenerator::emit_compare_branch(const Instruction& cmp, bool branch_if_true, Symbol label) {
+    using MI = MachineInstr;
+    MI::Opcode op = MI::BEQ;
+    bool swap = false;
+    switch (cmp.opcode) {
+    case Instruction::EQ: op = MI::BEQ; break;
+    case Instruction::NEQ: op = MI::BNE; break;
+    case Instruction::LT: op = MI::BLT; break;
+    case Instruction::GE: op = MI::BGE; break;
+    case Instruction::GT: op = MI::BLT; swap = true; break; // a > b  <=>  b < a
+    case Instruction::LE: op = MI::BGE; swap = true; break; // a <= b <=>  b >= a
+    default: break;
     }
+    if (!branch_if_true) op = invert_branch(op);
+    PhysReg r1 = use_reg(cmp.arg1, T0);
+    PhysReg r2 = use_reg(cmp.arg2, T1);
+    if (swap) std::swap(r1, r2);
+    MI mi(op, MachineOperand::r(r1), MachineOperand::r(r2), MachineOperand::label(m_func.internLabel(label)));
+    canonicalize_branch(mi);
+    out().push_back(mi);
+}
 
-    case Instruction::LT: { // С <
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->loadOperand(instr.arg2, "t1");
-        m_output << "  slt t2, t0, t1\n"; //  t0 < t1 t2=1
-        m_output << m_allocator->storeOperand(instr.result, "t2");
-        break;
+// 取得操作数所在的寄存器：常驻寄存器的直接返回，常量 0 用 zero，否则先加载到 scratch
+PhysReg CodeGenerator::use_reg(const Operand& op, PhysReg scratch) {
+    if (op.kind == Operand::CONST && op.value == 0) return ZERO;
+    PhysReg reg = m_allocator->getRegister(op);
+    if (reg != NO_REG) return reg;
+    m_allocator->loadOperand(op, scratch, out());
+    return scratch;
+}
+
+// 结果应写入的寄存器：常驻寄存器的直接写入，否则写入 scratch 后再由 storeOperand 存回
+PhysReg CodeGenerator::def_reg(const Operand& result, PhysReg scratch) {
+    PhysReg reg = m_allocator->getRegister(result);
+    return reg == NO_REG ? scratch : reg;
+}
+
+// 把记下的实参装入 a0-a7，第 9 个起的写到栈底的传出参数区。
+// IRGenerator 按从右到左的顺序生成 PARAM，最后一个 PARAM 才是第一个实参
+void CodeGenerator::load_call_args() {
+    const int n = (int)m_pending_params.size();
+    // 先写栈上的实参：要借用 t0，这时 a0-a7 还没开始装
+    for (int i = kNumArgRegs; i < n; ++i) {
+        PhysReg r = use_reg(m_pending_params[n - 1 - i], T0);
+        emit(MachineInstr::SW, MachineOperand::r(r), MachineOperand::mem(stack_arg_offset(i), SP));
     }
+    for (int i = 0; i < n && i < kNumArgRegs; ++i) {
+        m_allocator->loadOperand(m_pending_params[n - 1 - i], arg_reg(i), out());
+    }
+    m_pending_params.clear();
+}
 
-    case Instruction::GT: { //  >
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->loadOperand(instr.arg2, "t1");
-        m_output << "  sgt t2, t0, t1\n"; //  t0 > t1 t2=1 (sgtαָȼ slt t2, t1, t0)
-        m_output << m_allocator->storeOperand(instr.result, "t2");
+// generate_instruction 现在调用 m_allocator 来处理存储
+void CodeGenerator::generate_instruction(const Instruction& instr) {
+    using MI = MachineInstr;
+    using MO = MachineOperand;
+    switch (instr.opcode) {
+    case Instruction::ADD: case Instruction::SUB: case Instruction::MUL: case Instruction::DIV: case Instruction::MOD: {
+        // 加上 / 减去 12 位以内的常量用 addi
+        int imm;
+        const Operand* x = nullptr;
+        if (instr.opcode == Instruction::ADD && imm_operand(instr.arg2, imm)) x = &instr.arg1;
+        else if (instr.opcode == Instruction::ADD && imm_operand(instr.arg1, imm)) x = &instr.arg2;
+        else if (instr.opcode == Instruction::SUB && instr.arg2.kind == Operand::CONST && fits_imm12(-(long)instr.arg2.value)) {
+            x = &instr.arg1;
+            imm = -instr.arg2.value;
+        }
+        if (x) {
+            PhysReg r1 = use_reg(*x, T0);
+            PhysReg rd = def_reg(instr.result, T2);
+            emit(MI::ADDI, MO::r(rd), MO::r(r1), MO::imm(imm));
+            m_allocator->storeOperand(instr.result, rd, out());
+            break;
+        }
+        // 乘以 / 除以 / 模常量：换成移位、加减或乘高位的序列
+        if (m_strength_reduction && instr.opcode != Instruction::ADD && instr.opcode != Instruction::SUB &&
+            (instr.arg2.kind == Operand::CONST || (instr.opcode == Instruction::MUL && instr.arg1.kind == Operand::CONST))) {
+            const bool rhs_const = instr.arg2.kind == Operand::CONST;
+            const int32_t c = rhs_const ? instr.arg2.value : instr.arg1.value;
+            std::vector<MachineInstr> seq;
+            bool expanded;
+            PhysReg r1 = use_reg(rhs_const ? instr.arg1 : instr.arg2, T0);
+            PhysReg rd = def_reg(instr.result, T2);
+            if (instr.opcode == Instruction::MUL) expanded = expand_mul_by_constant(rd, r1, c, T1, T2, seq);
+            else if (instr.opcode == Instruction::DIV) expanded = expand_div_by_constant(rd, r1, c, T1, T2, seq);
+            else expanded = expand_rem_by_constant(rd, r1, c, T1, T2, seq);
+            if (expanded) {
+                out().insert(out().end(), seq.begin(), seq.end());
+            }
+            else { // 不划算：常量装入 t1 后照常用 mul/div/rem
+                const MI::Opcode op = instr.opcode == Instruction::MUL ? MI::MUL : instr.opcode == Instruction::DIV ? MI::DIV : MI::REM;
+                emit(MI::LI, MO::r(T1), MO::imm(c));
+                emit(op, MO::r(rd), MO::r(r1), MO::r(T1));
+            }
+            m_allocator->storeOperand(instr.result, rd, out());
+            break;
+        }
+        PhysReg r1 = use_reg(instr.arg1, T0);
+        PhysReg r2 = use_reg(instr.arg2, T1);
+        PhysReg rd = def_reg(instr.result, T2);
+        MI::Opcode op = MI::ADD;
+        if (instr.opcode == Instruction::SUB) op = MI::SUB;
+        if (instr.opcode == Instruction::MUL) op = MI::MUL;
+        if (instr.opcode == Instruction::DIV) op = MI::DIV;
+        if (instr.opcode == Instruction::MOD) op = MI::REM;
+        emit(op, MO::r(rd), MO::r(r1), MO::r(r2));
+        m_allocator->storeOperand(instr.result, rd, out());
+        break;
+    }
+    case Instruction::NOT: { // 逻辑非
+        PhysReg r1 = use_reg(instr.arg1, T0);
+        PhysReg rd = def_reg(instr.result, T0);
+        emit(MI::SEQZ, MO::r(rd), MO::r(r1)); // 如果 r1 为 0，则 rd=1，否则 rd=0
+        m_allocator->storeOperand(instr.result, rd, out());
         break;
     }
 
-    case Instruction::LE: { // Сڵ <= ()
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->loadOperand(instr.arg2, "t1");
-        m_output << "  sgt t2, t0, t1\n"; // t2 = (t0 > t1)
-        m_output << "  xori t2, t2, 1\n"; // t2 = !t2
-        m_output << m_allocator->storeOperand(instr.result, "t2");
+    case Instruction::EQ: case Instruction::NEQ: { // 等于 == / 不等于 !=
+        const MI::Opcode set = instr.opcode == Instruction::EQ ? MI::SEQZ : MI::SNEZ;
+        // 与常量比较：减去常量（是 0 就不用减）后看是否为 0
+        const bool rhs_const = instr.arg2.kind == Operand::CONST;
+        const Operand& c = rhs_const ? instr.arg2 : instr.arg1;
+        const Operand& x = rhs_const ? instr.arg1 : instr.arg2;
+        if (c.kind == Operand::CONST && fits_imm12(-(long)c.value)) {
+            PhysReg r1 = use_reg(x, T0);
+            PhysReg rd = def_reg(instr.result, T2);
+            if (c.value != 0) {
+                emit(MI::ADDI, MO::r(rd), MO::r(r1), MO::imm(-c.value));
+                r1 = rd;
+            }
+            emit(set, MO::r(rd), MO::r(r1));
+            m_allocator->storeOperand(instr.result, rd, out());
+            break;
+        }
+        PhysReg r1 = use_reg(instr.arg1, T0);
+        PhysReg r2 = use_reg(instr.arg2, T1);
+        PhysReg rd = def_reg(instr.result, T2);
+        emit(MI::SUB, MO::r(rd), MO::r(r1), MO::r(r2));
+        emit(set, MO::r(rd), MO::r(rd)); // 差值为 0 / 不为 0 时 rd=1
+        m_allocator->storeOperand(instr.result, rd, out());
         break;
     }
 
-    case Instruction::GE: { // ڵ >=
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->loadOperand(instr.arg2, "t1");
-        m_output << "  slt t2, t0, t1\n"; // t2 = (t0 < t1)
-        m_output << "  xori t2, t2, 1\n"; // t2 = !t2
-        m_output << m_allocator->storeOperand(instr.result, "t2");
+    case Instruction::LT: case Instruction::GT: case Instruction::LE: case Instruction::GE: {
+        // 能化成 x < imm（可能再取反）的形式用 slti：
+        //   x < c  ->  slti x, c          c > x  ->  slti x, c
+        //   x <= c ->  slti x, c + 1      x >= c ->  slti x, c; xori 1
+        int imm;
+        const Operand* x = nullptr;
+        bool negate = false;
+        if (instr.opcode == Instruction::LT && imm_operand(instr.arg2, imm)) x = &instr.arg1;
+        else if (instr.opcode == Instruction::GT && imm_operand(instr.arg1, imm)) x = &instr.arg2;
+        else if (instr.opcode == Instruction::LE && instr.arg2.kind == Operand::CONST && fits_imm12((long)instr.arg2.value + 1)) {
+            x = &instr.arg1;
+            imm = instr.arg2.value + 1;
+        }
+        else if (instr.opcode == Instruction::GE && imm_operand(instr.arg2, imm)) {
+            x = &instr.arg1;
+            negate = true;
+        }
+        if (x) {
+            PhysReg r1 = use_reg(*x, T0);
+            PhysReg rd = def_reg(instr.result, T2);
+            emit(MI::SLTI, MO::r(rd), MO::r(r1), MO::imm(imm));
+            if (negate) emit(MI::XORI, MO::r(rd), MO::r(rd), MO::imm(1));
+            m_allocator->storeOperand(instr.result, rd, out());
+            break;
+        }
+
+        PhysReg r1 = use_reg(instr.arg1, T0);
+        PhysReg r2 = use_reg(instr.arg2, T1);
+        PhysReg rd = def_reg(instr.result, T2);
+        switch (instr.opcode) {
+        case Instruction::LT: // 小于 <
+            emit(MI::SLT, MO::r(rd), MO::r(r1), MO::r(r2)); // 如果 r1 < r2，则 rd=1
+            break;
+        case Instruction::GT: // 大于 >
+            emit(MI::SGT, MO::r(rd), MO::r(r1), MO::r(r2)); // 如果 r1 > r2，则 rd=1 (sgt是伪指令，等价于 slt rd, r2, r1)
+            break;
+        case Instruction::LE: // 小于等于 <= (修正)
+            emit(MI::SGT, MO::r(rd), MO::r(r1), MO::r(r2)); // rd = (r1 > r2)
+            emit(MI::XORI, MO::r(rd), MO::r(rd), MO::imm(1)); // rd = !rd
+            break;
+        default: // 大于等于 >=
+            emit(MI::SLT, MO::r(rd), MO::r(r1), MO::r(r2)); // rd = (r1 < r2)
+            emit(MI::XORI, MO::r(rd), MO::r(rd), MO::imm(1)); // rd = !rd
+            break;
+        }
+        m_allocator->storeOperand(instr.result, rd, out());
         break;
     }
 
     case Instruction::JUMP_IF_ZERO: {
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << "  beqz t0, " << instr.arg2.name << "\n";
+        PhysReg r1 = use_reg(instr.arg1, T0);
+        emit(MI::BEQZ, MO::r(r1), MO::label(m_func.internLabel(instr.arg2.name)));
         break;
     }
 
-    case Instruction::JUMP_IF_NZERO: { // JUMP_IF_NZERO (Ϊ0ת)
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << "  bnez t0, " << instr.arg2.name << "\n";
-        ;
+    case Instruction::JUMP_IF_NZERO: { // JUMP_IF_NZERO (不为0则跳转)
+        PhysReg r1 = use_reg(instr.arg1, T0);
+        emit(MI::BNEZ, MO::r(r1), MO::label(m_func.internLabel(instr.arg2.name)));
+        break;
+    }
     case Instruction::JUMP:
-        m_output << "  j " << instr.arg1.name << "\n";
+        emit(MI::J, MO::label(m_func.internLabel(instr.arg1.name)));
         break;
-    case Instruction::ASSIGN:
-        m_output << m_allocator->loadOperand(instr.arg1, "t0");
-        m_output << m_allocator->storeOperand(instr.result, "t0");
+    case Instruction::ASSIGN: {
+        // 源操作数不在寄存器里时直接加载到目标寄存器；寄存器到寄存器只需一条 mv
+        PhysReg r1 = use_reg(instr.arg1, def_reg(instr.result, T0));
+        m_allocator->storeOperand(instr.result, r1, out());
         break;
+    }
     case Instruction::RET: {
         if (instr.arg1.kind != Operand::NONE) {
-            m_output << m_allocator->loadOperand(instr.arg1, "a0");
+            m_allocator->loadOperand(instr.arg1, A0, out());
         }
-        // ֱӻȡβ
-        m_output << m_allocator->getEpilogue();
+        // 直接生成尾声代码
+        m_allocator->emitEpilogue(out());
         break;
     }
     case Instruction::PARAM:
-        // loadOperand ڲᴦ߼
-        m_output << m_allocator->loadOperand(instr.arg1, "a" + std::to_string(m_param_idx));
-        m_param_idx++;
+        // 实参先记下来，到 CALL 时再统一装入 a0-a7，
+        // 这样实参的值在调用前一直留在原来的位置，寄存器分配器也据此计算活跃区间
+        m_pending_params.push_back(instr.arg1);
         break;
-    case Instruction::CALL:
-        m_param_idx = 0; // ò
-        m_output << "  call " << instr.arg1.name << "\n";
+    case Instruction::CALL: {
+        load_call_args();
+        emit(MI::CALL, MO::label(m_func.internLabel(instr.arg1.name)));
         if (instr.result.kind != Operand::NONE) {
-            // ֵ a0 浽λ
-            m_output << m_allocator->storeOperand(instr.result, "a0");
+            // 将返回值 a0 存到结果操作数的位置
+            m_allocator->storeOperand(instr.result, A0, out());
         }
         break;
+    }
+    case Instruction::TAIL_CALL:
+        // 实参装好后拆掉自己的栈帧，被调用者直接返回到我们的调用者。
+        // 栈上的实参没有地方放（自己的栈帧马上就拆掉了），TailCall 不会生成这样的尾调用
+        if (m_pending_params.size() > (size_t)kNumArgRegs) {
+            throw std::runtime_error("CodeGenerator Error: tail call with stack arguments in '" + m_func.name + "'.");
+        }
+        load_call_args();
+        m_allocator->emitTeardown(out());
+        emit(MI::TAIL, MO::label(m_func.internLabel(instr.arg1.name)));
+        break;
     case Instruction::LABEL:
-        // Label ɴ룬 generate_function 
+        // Label 不生成代码，由 generate_function 处理
         break;
     default:
-        m_output << "  # Unhandled OpCode: " << instr.opcode << "\n";
-        break;
-    }
+        throw std::runtime_error("CodeGenerator Error: unhandled opcode " + std::to_string(instr.opcode) +
+            " in function '" + m_func.name + "'.");
     }
 }
 
-//ںȷ main 
+//主入口函数，确保 main 函数最先生成
 std::string CodeGenerator::generate(const ModuleIR& module) {
     m_output.str("");
     m_output.clear();
     m_output << ".text\n.globl main\n\n";
 
-    // 1. Ҳ main 
+    // 1. 查找并优先生成 main 函数
     const FunctionIR* main_func = nullptr;
     for (const auto& func : module.functions) {
-        if (func.name == "main") {
+        if (func.name.str() == "main") {
             main_func = &func;
             break;
         }
     }
 
     if (main_func) {
-        m_param_idx = 0; // Ϊ main ò
         generate_function(*main_func);
         m_output << "\n";
     }
     else {
-        // һĿִг˵û main 
+        // 对于一个独立的可执行程序来说，没有 main 函数是致命错误
         throw std::runtime_error("CodeGenerator Error: 'main' function not found in module.");
     }
 
-    // 2. з main 
+    // 2. 生成其他所有非 main 函数
     for (const auto& func : module.functions) {
-        if (func.name != "main") {
-            m_param_idx = 0; // ÿʼǰò
+        if (func.name.str() != "main") {
             generate_function(func);
             m_output << "\n";
         }
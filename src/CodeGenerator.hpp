@@ -2,24 +2,85 @@
 
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <memory> // For std::unique_ptr
 #include "ir.hpp"
-#include "RegisterAllocator.hpp" // ½ӿ
+#include "RegisterAllocator.hpp" // 包含新接口
+#include "MachineIR.hpp"
+#include "Peephole.hpp"
+#include "Scheduler.hpp"
+
+// 可选的寄存器分配策略
+enum class AllocatorKind { SpillEverything, LinearScan, GraphColoring };
 
 class CodeGenerator {
 public:
-    // ڹ캯оʹַ
-    CodeGenerator();
+    // 在构造函数中决定使用哪种分配策略
+    explicit CodeGenerator(AllocatorKind kind = AllocatorKind::LinearScan);
 
     std::string generate(const ModuleIR& module);
 
+    // 打开后每个函数生成完都经过一遍窥孔优化
+    void setPeephole(bool enabled) { m_peephole_enabled = enabled; }
+    const PeepholeOptimizer& peephole() const { return m_peephole; }
+    // 打开后乘以 / 除以 / 模常量时用移位和乘高位序列代替 mul/div/rem
+    void setStrengthReduction(bool enabled) { m_strength_reduction = enabled; }
+    // 指令调度：pre_ra 在寄存器分配之前调度 IR 的块，post_ra 在窥孔优化之后调度机器指令
+    void setScheduling(bool pre_ra, bool post_ra, const SchedModel& model) {
+        m_schedule_pre_ra = pre_ra;
+        m_schedule_post_ra = post_ra;
+        m_scheduler = InstructionScheduler(model);
+    }
+    const InstructionScheduler& scheduler() const { return m_scheduler; }
+
 private:
     void generate_function(const FunctionIR& func);
     void generate_instruction(const Instruction& instr);
 
-    std::stringstream m_output;
-    int m_param_idx;
+    // --- 指令选择：在块内匹配多条 IR 指令组成的模式 ---
+    // 匹配到的模式；第一条指令的结果都不写出
+    struct Pattern {
+        enum Kind { NONE, COMPARE_BRANCH, NOT_BRANCH, CONST_JUMP };
+        Kind kind = NONE;
+        size_t length = 0;           // 覆盖的 IR 指令条数
+        bool branch_if_true = false; // COMPARE_BRANCH / NOT_BRANCH：结果为真时跳转
+        Symbol dest;                 // 跳转目标
+    };
+    Pattern match_pattern(const FunctionIR& func, size_t b, size_t i) const;
+    // 生成匹配到的模式，返回覆盖的 IR 指令条数，没有匹配时返回 0
+    size_t select_pattern(const FunctionIR& func, size_t b, size_t i);
+    void find_folded_values(const FunctionIR& func);
+    void emit_compare_branch(const Instruction& cmp, bool branch_if_true, Symbol label);
+    bool is_single_use(const Operand& op) const;
+    void count_uses(const FunctionIR& func);
+    PhysReg use_reg(const Operand& op, PhysReg scratch);
+    PhysReg def_reg(const Operand& result, PhysReg scratch);
+    void load_call_args();
+
+    // 当前块的指令表；分配器生成的装载/存储也追加到这里
+    std::vector<MachineInstr>& out() { return m_func.blocks.back().instrs; }
+    void emit(MachineInstr::Opcode op, MachineOperand a = MachineOperand(), MachineOperand b = MachineOperand(),
+        MachineOperand c = MachineOperand()) {
+        out().emplace_back(op, a, b, c);
+    }
+    void start_block(int label);
 
-    // һӿڵָ
+    MachineFunction m_func;     // 正在生成的函数
+    std::stringstream m_output; // 整个模块的汇编
+    std::vector<Operand> m_pending_params; // 等待 CALL 装入 a0-a7 的实参
+    std::unordered_map<ValueKey, int> m_use_count; // 每个值在函数里被使用的次数
+    std::unordered_set<ValueKey> m_folded;         // 每次定值都被模式吸收、从不写出的值
+    std::unordered_map<Symbol, size_t> m_block_of_label;
+
+    // 持有一个分配器接口的智能指针
     std::unique_ptr<RegisterAllocator> m_allocator;
+
+    bool m_peephole_enabled = false;
+    bool m_strength_reduction = false;
+    PeepholeOptimizer m_peephole;
+    bool m_schedule_pre_ra = false;
+    bool m_schedule_post_ra = false;
+    InstructionScheduler m_scheduler;
 };
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "CompilationContext.hpp"
+#include "parser.tab.h"
+#include <stdexcept>
+
+// lexer.l 生成的可重入扫描器接口（extra-type 是 CompilationContext*）
+int yylex_init_extra(CompilationContext* extra, yyscan_t* scanner);
+void yyset_in(FILE* in, yyscan_t scanner);
+int yylex_destroy(yyscan_t scanner);
+
+namespace {
+
+// 保证出异常时扫描器也会销毁
+class Scanner {
+public:
+    explicit Scanner(CompilationContext& ctx) {
+        if (yylex_init_extra(&ctx, &m_scanner) != 0) {
+            throw std::runtime_error("Parser Error: failed to create the scanner.");
+        }
+    }
+    ~Scanner() { yylex_destroy(m_scanner); }
+    Scanner(const Scanner&) = delete;
+    Scanner& operator=(const Scanner&) = delete;
+
+    yyscan_t get() const { return m_scanner; }
+
+private:
+    yyscan_t m_scanner = nullptr;
+};
+
+} // namespace
+
+bool CompilationContext::parse(FILE* in) {
+    Scanner scanner(*this);
+    yyset_in(in, scanner.get());
+    const int result = yyparse(scanner.get(), *this);
+    return result == 0 && m_root != nullptr;
+}
+
+void CompilationContext::releaseAst() {
+    m_arena.release();
+    m_root = nullptr;
+}
+
+void CompilationContext::error(const char* phase, int line, const std::string& message) {
+    m_diagnostics.push_back({ phase, line, message });
+}
+
+void CompilationContext::printDiagnostics(std::ostream& os) const {
+    for (const auto& d : m_diagnostics) {
+        os << d.phase << " error at line " << d.line << ": " << d.message << "\n";
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Symbol.hpp"
+#include "ast.hpp"
+
+// 前端报告的一条错误
+struct Diagnostic {
+    const char* phase;    // "Lexer" / "Parse" / "Semantic"
+    int line;
+    std::string message;
+};
+
+/**
+ * @class CompilationContext
+ * @brief 一次编译（一个源文件）的状态
+ *
+ * 拥有这次编译的符号表、AST 所在的 Arena、语法树根和诊断信息。词法分析器（reentrant Flex）
+ * 和语法分析器（pure Bison）的全部状态都在 parse() 创建的 yyscan_t 和 yyparse 的栈上，
+ * 没有 yyin/g_root/yydebug 之类的全局变量：不同的 CompilationContext 互不影响，
+ * 可以在不同线程里同时编译不同的文件，也可以在一个常驻进程里一个接一个地编译。
+ * 名字驻留在这次编译自己的符号表里：构造时把它绑定到当前线程（SymbolTable::Scope），
+ * 之后语法分析、IR 生成、优化和代码生成里的 Symbol 都用这张表，析构时连同所有名字一起释放。
+ * 因此整个编译（直到生成汇编）都要在创建 CompilationContext 的线程里、在它的生存期内完成。
+ */
+class CompilationContext {
+public:
+    CompilationContext() = default;
+    CompilationContext(const CompilationContext&) = delete;
+    CompilationContext& operator=(const CompilationContext&) = delete;
+
+    // 从 in 读入整个源文件并建立 AST；成功时 root() 是语法树根，错误记在 diagnostics() 里
+    bool parse(FILE* in);
+
+    SymbolTable& symbols() { return m_symbols; }
+    Arena& arena() { return m_arena; }
+    Program* root() const { return m_root; }
+    void setRoot(Program* root) { m_root = root; }
+    // AST 用完（生成 IR 之后）整体释放，root() 随之失效
+    void releaseAst();
+
+    void error(const char* phase, int line, const std::string& message);
+    const std::vector<Diagnostic>& diagnostics() const { return m_diagnostics; }
+    // 按 "<phase> error at line N: message" 的格式逐条打印
+    void printDiagnostics(std::ostream& os) const;
+
+private:
+    SymbolTable m_symbols;
+    SymbolTable::Scope m_symbol_scope{ m_symbols };
+    Arena m_arena;
+    Program* m_root = nullptr;
+    std::vector<Diagnostic> m_diagnostics;
+};
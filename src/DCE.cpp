@@ -0,0 +1,80 @@
+#include "DCE.hpp"
+#include "CFG.hpp"
+#include "Liveness.hpp"
+#include <unordered_map>
+#include <unordered_set>
+
+// 有副作用或决定控制流的指令，不能因为“结果没人用”而删除
+static bool is_root(const Instruction& instr) {
+    switch (instr.opcode) {
+    case Instruction::CALL: case Instruction::TAIL_CALL: case Instruction::PARAM: case Instruction::RET:
+    case Instruction::JUMP: case Instruction::JUMP_IF_ZERO: case Instruction::JUMP_IF_NZERO:
+    case Instruction::LABEL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool DeadCodeEliminationPass::runOnFunction(FunctionIR& func) {
+    bool changed = remove_unreachable_blocks(func);
+
+    // 1. 跳转/RET 之后的指令
+    for (auto& bb : func.blocks) {
+        const int end = reachable_end(bb);
+        if (end < (int)bb.instructions.size()) {
+            bb.instructions.resize(end);
+            changed = true;
+        }
+    }
+
+    // 2. 标记
+    std::unordered_map<ValueKey, std::vector<const Instruction*>> defs;
+    std::vector<const Instruction*> work;
+    std::unordered_set<const Instruction*> marked;
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            if (const Operand* def = instr_def(instr)) {
+                defs[Liveness::keyOf(*def)].push_back(&instr);
+            }
+            if (is_root(instr)) {
+                marked.insert(&instr);
+                work.push_back(&instr);
+            }
+        }
+    }
+
+    std::unordered_set<ValueKey> live;
+    while (!work.empty()) {
+        const Instruction* instr = work.back();
+        work.pop_back();
+        for_each_use(*instr, [&](const Operand& op) {
+            ValueKey key = Liveness::keyOf(op);
+            if (!live.insert(key).second) return;
+            auto it = defs.find(key);
+            if (it == defs.end()) return;
+            for (const Instruction* def : it->second) {
+                if (marked.insert(def).second) work.push_back(def);
+            }
+        });
+    }
+
+    // 3. 清除
+    for (auto& bb : func.blocks) {
+        std::vector<Instruction> kept;
+        kept.reserve(bb.instructions.size());
+        for (auto& instr : bb.instructions) {
+            if (!marked.count(&instr)) {
+                changed = true;
+                continue;
+            }
+            if (instr.opcode == Instruction::CALL && is_value(instr.result) && !live.count(Liveness::keyOf(instr.result))) {
+                instr.result = Operand();
+                changed = true;
+            }
+            kept.push_back(std::move(instr));
+        }
+        bb.instructions = std::move(kept);
+    }
+    return changed;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class DeadCodeEliminationPass
+ * @brief 删除死代码和不可达的块
+ *
+ * 先删掉从入口不可达的块和跳转/RET 之后永远不会执行的指令，
+ * 再做标记-清除：有副作用或影响控制流的指令（CALL、PARAM、RET、跳转）是根，
+ * 根用到的值的所有定值指令被标记为活，依此传递；没有被标记的指令删除。
+ * 结果没人用的 CALL 保留调用，只去掉结果，省掉一次存储和一个栈槽。
+ * 按名字标记，因此在 SSA 和非 SSA 形式上都能用。
+ */
+class DeadCodeEliminationPass : public FunctionPass {
+public:
+    const char* name() const override { return "dce"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
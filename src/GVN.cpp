@@ -0,0 +1,200 @@
+#include "GVN.hpp"
+#include "Liveness.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+// 纯运算的哈希键：操作码和两个操作数的键，NOT 只用 a
+struct ExprKey {
+    int op;
+    ValueKey a, b;
+    bool operator==(const ExprKey& o) const { return op == o.op && a == o.a && b == o.b; }
+};
+
+struct ExprKeyHash {
+    size_t operator()(const ExprKey& k) const {
+        size_t h = std::hash<ValueKey>()(k.a);
+        h = h * 31 + std::hash<ValueKey>()(k.b);
+        return h * 31 + (size_t)k.op;
+    }
+};
+
+class GVNBuilder {
+public:
+    explicit GVNBuilder(FunctionIR& func) : m_func(func) {}
+    bool run();
+
+private:
+    void walkDomTree();
+    void visitBlock(int b, std::vector<ExprKey>& scope);
+    const Operand& resolve(const Operand& op) const;
+    static ValueKey operandKey(const Operand& op);
+    static bool expressionKey(const Instruction& instr, ExprKey& key);
+
+    FunctionIR& m_func;
+    std::unordered_map<ValueKey, Operand> m_replace;            // 被消掉的值 -> 代替它的操作数
+    std::unordered_map<ExprKey, Operand, ExprKeyHash> m_table;  // 表达式 -> 持有该值的操作数
+    std::vector<bool> m_dead;                                   // 按 (块, 下标) 标记要删除的指令
+    std::vector<int> m_block_base;
+};
+
+const Operand& GVNBuilder::resolve(const Operand& op) const {
+    const Operand* cur = &op;
+    while (is_value(*cur)) {
+        auto it = m_replace.find(Liveness::keyOf(*cur));
+        if (it == m_replace.end()) break;
+        cur = &it->second;
+    }
+    return *cur;
+}
+
+ValueKey GVNBuilder::operandKey(const Operand& op) {
+    // 常量放在 value_key 不用的高位区间，不会与变量/临时变量冲突
+    if (op.kind == Operand::CONST) return (uint64_t(3) << 32) | uint32_t(op.value);
+    return Liveness::keyOf(op);
+}
+
+// 纯运算的哈希键；其他指令（CALL、跳转等）返回 false
+bool GVNBuilder::expressionKey(const Instruction& instr, ExprKey& key) {
+    Instruction::OpCode op = instr.opcode;
+    ValueKey a = operandKey(instr.arg1), b = 0;
+    switch (op) {
+    case Instruction::NOT:
+        key = { op, a, 0 };
+        return true;
+    case Instruction::ADD: case Instruction::MUL: case Instruction::EQ: case Instruction::NEQ:
+        b = operandKey(instr.arg2);
+        if (b < a) std::swap(a, b); // 可交换：规范顺序
+        break;
+    case Instruction::GT: case Instruction::GE:
+        // a > b 等价于 b < a
+        op = op == Instruction::GT ? Instruction::LT : Instruction::LE;
+        b = a;
+        a = operandKey(instr.arg2);
+        break;
+    case Instruction::SUB: case Instruction::DIV: case Instruction::MOD:
+    case Instruction::LT: case Instruction::LE:
+        b = operandKey(instr.arg2);
+        break;
+    default:
+        return false;
+    }
+    key = { op, a, b };
+    return true;
+}
+
+bool GVNBuilder::run() {
+    const int n = (int)m_func.blocks.size();
+    if (n == 0) return false;
+    m_block_base.assign(n + 1, 0);
+    for (int b = 0; b < n; ++b) {
+        m_block_base[b + 1] = m_block_base[b] + (int)m_func.blocks[b].instructions.size();
+    }
+    m_dead.assign(m_block_base[n], false);
+
+    walkDomTree();
+    if (m_replace.empty()) return false;
+
+    // 替换剩下的所有使用点（包括后继块 PHI 中的实参），删除被消掉的指令
+    for (int b = 0; b < n; ++b) {
+        auto& instrs = m_func.blocks[b].instructions;
+        std::vector<Instruction> kept;
+        kept.reserve(instrs.size());
+        for (int i = 0; i < (int)instrs.size(); ++i) {
+            if (m_dead[m_block_base[b] + i]) continue;
+            for_each_use(instrs[i], [&](Operand& op) { op = resolve(op); });
+            kept.push_back(std::move(instrs[i]));
+        }
+        instrs = std::move(kept);
+    }
+    return true;
+}
+
+// 沿支配树先序遍历。用显式栈而不是递归：支配树可以和块数一样深。
+// scope 记录加入表中的键，每一帧记住进入时 scope 的长度，离开时把之后加入的撤销
+void GVNBuilder::walkDomTree() {
+    struct Frame {
+        int block;
+        size_t next_child;
+        size_t scope_begin;
+    };
+    std::vector<ExprKey> scope;
+    std::vector<Frame> stack;
+    visitBlock(0, scope);
+    stack.push_back({ 0, 0, 0 });
+    while (!stack.empty()) {
+        Frame& top = stack.back();
+        const auto& children = m_func.cfg.dom_children[top.block];
+        if (top.next_child < children.size()) {
+            const int c = children[top.next_child++];
+            const size_t begin = scope.size();
+            visitBlock(c, scope);
+            stack.push_back({ c, 0, begin });
+            continue;
+        }
+        while (scope.size() > top.scope_begin) {
+            m_table.erase(scope.back());
+            scope.pop_back();
+        }
+        stack.pop_back();
+    }
+}
+
+void GVNBuilder::visitBlock(int b, std::vector<ExprKey>& scope) {
+    auto& instrs = m_func.blocks[b].instructions;
+
+    for (int i = 0; i < (int)instrs.size(); ++i) {
+        Instruction& instr = instrs[i];
+        if (instr.opcode != Instruction::PHI) {
+            for_each_use(instr, [&](Operand& op) { op = resolve(op); });
+        }
+        const Operand* def = instr_def(instr);
+        if (!def) continue;
+        const ValueKey def_key = Liveness::keyOf(*def);
+
+        // 复制传播
+        if (instr.opcode == Instruction::ASSIGN && instr.arg1.kind != Operand::NONE) {
+            m_replace[def_key] = instr.arg1;
+            m_dead[m_block_base[b] + i] = true;
+            continue;
+        }
+        // 所有实参都相同（或就是自己）的 PHI
+        if (instr.opcode == Instruction::PHI) {
+            const Operand* same = nullptr;
+            bool unique = !instr.phi_args.empty();
+            for (const auto& arg : instr.phi_args) {
+                const Operand& v = resolve(arg.value);
+                if (v.kind == Operand::NONE) { unique = false; break; }
+                if (is_value(v) && Liveness::keyOf(v) == def_key) continue;
+                if (!same) same = &v;
+                else if (operandKey(*same) != operandKey(v)) { unique = false; break; }
+            }
+            if (unique && same) {
+                m_replace[def_key] = *same;
+                m_dead[m_block_base[b] + i] = true;
+            }
+            continue;
+        }
+
+        ExprKey key;
+        if (!expressionKey(instr, key)) continue;
+        auto it = m_table.find(key);
+        if (it != m_table.end()) {
+            m_replace[def_key] = it->second;
+            m_dead[m_block_base[b] + i] = true;
+        }
+        else {
+            m_table.emplace(key, *def);
+            scope.push_back(key);
+        }
+    }
+}
+
+} // namespace
+
+bool GVNPass::runOnFunction(FunctionIR& func) {
+    if (!func.in_ssa) return false;
+    GVNBuilder builder(func);
+    return builder.run();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class GVNPass
+ * @brief 基于支配树的全局值编号 / 公共子表达式消除
+ *
+ * 在 SSA 形式上沿支配树先序遍历，用一张带作用域的哈希表记录
+ * (opcode, arg1, arg2) -> 已经算过该值的操作数。表项只在定值块支配的子树中可见，
+ * 所以命中时前面的定值一定支配当前指令，可以直接替换。
+ * ADD/MUL/EQ/NEQ 的操作数按规范顺序排列，GT/GE 改写成交换操作数的 LT/LE；
+ * 复制（ASSIGN）和所有实参相同的 PHI 直接把结果换成源操作数（复制传播）。
+ */
+class GVNPass : public FunctionPass {
+public:
+    const char* name() const override { return "gvn"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
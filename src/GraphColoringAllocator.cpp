@@ -0,0 +1,364 @@
+#include "GraphColoringAllocator.hpp"
+#include "LoopInfo.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int kInfiniteDegree = 1 << 30;
+}
+
+void GraphColoringAllocator::assignRegisters(const FunctionIR& func) {
+    build(func);
+    computeSpillCosts(func);
+    makeWorklist();
+
+    while (!m_simplify_worklist.empty() || !m_worklist_moves.empty()
+        || !m_freeze_worklist.empty() || !m_spill_worklist.empty()) {
+        if (!m_simplify_worklist.empty()) simplify();
+        else if (!m_worklist_moves.empty()) coalesce();
+        else if (!m_freeze_worklist.empty()) freeze();
+        else selectSpill();
+    }
+    assignColors();
+
+    for (int v = 0; v < m_num_values; ++v) {
+        m_assigned[v] = m_color[v] >= 0 ? m_colors[m_color[v]] : NO_REG;
+    }
+}
+
+// --- 建图 ---
+
+void GraphColoringAllocator::build(const FunctionIR& func) {
+    // 颜色顺序：优先用调用者保存寄存器，免去序言/尾声里的保存恢复
+    m_colors = callerSavedRegs();
+    m_colors.insert(m_colors.end(), calleeSavedRegs().begin(), calleeSavedRegs().end());
+    m_k = (int)m_colors.size();
+
+    m_num_values = m_liveness.numValues();
+    const int num_precolored = (int)callerSavedRegs().size();
+    const int n = m_num_values + num_precolored;
+
+    m_adj_set.clear();
+    m_adj_list.assign(n, {});
+    m_degree.assign(n, 0);
+    m_state.assign(n, INITIAL);
+    m_alias.assign(n, -1);
+    m_color.assign(n, -1);
+    m_move_list.assign(n, {});
+    m_moves.clear();
+    m_move_state.clear();
+    m_simplify_worklist.clear();
+    m_freeze_worklist.clear();
+    m_spill_worklist.clear();
+    m_worklist_moves.clear();
+    m_active_moves.clear();
+    m_select_stack.clear();
+
+    // 调用者保存的寄存器作为预着色结点，代表被调用破坏的寄存器
+    for (int i = 0; i < num_precolored; ++i) {
+        m_state[m_num_values + i] = PRECOLORED;
+        m_color[m_num_values + i] = i;
+        m_degree[m_num_values + i] = kInfiniteDegree;
+    }
+
+    for (int b = 0; b < m_liveness.numBlocks(); ++b) {
+        const auto& instrs = func.blocks[b].instructions;
+        m_liveness.walkBlockBackward(func, b, [&](int i, const LiveSet& live) {
+            const Instruction& instr = instrs[i];
+            const Operand* def_op = instr_def(instr);
+            const int def = def_op ? m_liveness.indexOf(*def_op) : -1;
+
+            // 复制指令：源与目标之间不连干涉边，留给合并
+            int move_src = -1;
+            if (instr.opcode == Instruction::ASSIGN && def >= 0 && is_value(instr.arg1)) {
+                move_src = m_liveness.indexOf(instr.arg1);
+                if (move_src != def && !isFolded(def) && !isFolded(move_src)) {
+                    int m = (int)m_moves.size();
+                    m_moves.push_back({ def, move_src });
+                    m_move_state.push_back(MOVE_WORKLIST);
+                    m_worklist_moves.insert(m);
+                    m_move_list[def].push_back(m);
+                    m_move_list[move_src].push_back(m);
+                }
+            }
+
+            if (def >= 0) {
+                live.forEach([&](int l) {
+                    if (l != move_src) addEdge(def, l);
+                });
+            }
+            // 调用之后仍活跃的值跨越了调用，不能放在调用者保存寄存器里
+            if (instr.opcode == Instruction::CALL) {
+                live.forEach([&](int l) {
+                    if (l == def) return;
+                    for (int p = m_num_values; p < n; ++p) addEdge(l, p);
+                });
+            }
+        });
+    }
+
+    // 函数入口处活跃的值（参数）同时被定义，两两干涉
+    if (m_liveness.numBlocks() > 0) {
+        const auto& entry_live = m_liveness.liveIn(0);
+        entry_live.forEach([&](int u) {
+            entry_live.forEach([&](int v) {
+                if (v > u) addEdge(u, v);
+            });
+        });
+    }
+}
+
+// 溢出代价：每次定值/使用计 10^循环深度，循环深度取自然循环的嵌套层数。
+void GraphColoringAllocator::computeSpillCosts(const FunctionIR& func) {
+    const int nb = m_liveness.numBlocks();
+    LoopInfo loops;
+    loops.compute(func);
+
+    m_spill_cost.assign(m_num_values, 0.0);
+    for (int b = 0; b < nb; ++b) {
+        const double weight = std::pow(10.0, std::min(loops.depth(b), 8));
+        const auto& instrs = func.blocks[b].instructions;
+        for (int i = 0; i < m_liveness.reachableEnd(b); ++i) {
+            if (const Operand* def = instr_def(instrs[i])) m_spill_cost[m_liveness.indexOf(*def)] += weight;
+            for_each_use(instrs[i], [&](const Operand& op) { m_spill_cost[m_liveness.indexOf(op)] += weight; });
+        }
+    }
+}
+
+// 被吸收的值不在图里：它们不占寄存器，也不妨碍别的值
+void GraphColoringAllocator::addEdge(int u, int v) {
+    if (u == v || isFolded(u) || isFolded(v) || adjacent(u, v)) return;
+    long long a = std::min(u, v), b = std::max(u, v);
+    m_adj_set.insert((a << 32) | b);
+    if (m_state[u] != PRECOLORED) {
+        m_adj_list[u].push_back(v);
+        m_degree[u]++;
+    }
+    if (m_state[v] != PRECOLORED) {
+        m_adj_list[v].push_back(u);
+        m_degree[v]++;
+    }
+}
+
+bool GraphColoringAllocator::adjacent(int u, int v) const {
+    long long a = std::min(u, v), b = std::max(u, v);
+    return m_adj_set.count((a << 32) | b) != 0;
+}
+
+// --- 工作表维护 ---
+
+void GraphColoringAllocator::setState(int n, NodeState s) {
+    switch (m_state[n]) {
+    case SIMPLIFY: m_simplify_worklist.erase(n); break;
+    case FREEZE: m_freeze_worklist.erase(n); break;
+    case SPILL: m_spill_worklist.erase(n); break;
+    default: break;
+    }
+    m_state[n] = s;
+    switch (s) {
+    case SIMPLIFY: m_simplify_worklist.insert(n); break;
+    case FREEZE: m_freeze_worklist.insert(n); break;
+    case SPILL: m_spill_worklist.insert(n); break;
+    default: break;
+    }
+}
+
+void GraphColoringAllocator::setMoveState(int m, MoveState s) {
+    if (m_move_state[m] == MOVE_WORKLIST) m_worklist_moves.erase(m);
+    if (m_move_state[m] == MOVE_ACTIVE) m_active_moves.erase(m);
+    m_move_state[m] = s;
+    if (s == MOVE_WORKLIST) m_worklist_moves.insert(m);
+    if (s == MOVE_ACTIVE) m_active_moves.insert(m);
+}
+
+template<class F>
+void GraphColoringAllocator::forEachAdjacent(int n, F f) const {
+    std::vector<int> adj;
+    for (int w : m_adj_list[n]) {
+        if (m_state[w] != SELECTED && m_state[w] != COALESCED) adj.push_back(w);
+    }
+    for (int w : adj) f(w);
+}
+
+template<class F>
+void GraphColoringAllocator::forEachNodeMove(int n, F f) const {
+    std::vector<int> moves;
+    for (int m : m_move_list[n]) {
+        if (m_move_state[m] == MOVE_WORKLIST || m_move_state[m] == MOVE_ACTIVE) moves.push_back(m);
+    }
+    for (int m : moves) f(m);
+}
+
+bool GraphColoringAllocator::moveRelated(int n) const {
+    for (int m : m_move_list[n]) {
+        if (m_move_state[m] == MOVE_WORKLIST || m_move_state[m] == MOVE_ACTIVE) return true;
+    }
+    return false;
+}
+
+void GraphColoringAllocator::makeWorklist() {
+    for (int n = 0; n < m_num_values; ++n) {
+        if (isFolded(n)) continue; // 不进任何工作表，m_color 保持 -1
+        if (m_degree[n] >= m_k) setState(n, SPILL);
+        else if (moveRelated(n)) setState(n, FREEZE);
+        else setState(n, SIMPLIFY);
+    }
+}
+
+void GraphColoringAllocator::enableMoves(int n) {
+    forEachNodeMove(n, [&](int m) {
+        if (m_move_state[m] == MOVE_ACTIVE) setMoveState(m, MOVE_WORKLIST);
+    });
+}
+
+void GraphColoringAllocator::decrementDegree(int m) {
+    if (m_state[m] == PRECOLORED) return;
+    int d = m_degree[m]--;
+    if (d == m_k) {
+        enableMoves(m);
+        forEachAdjacent(m, [&](int w) { enableMoves(w); });
+        if (m_state[m] == SPILL) setState(m, moveRelated(m) ? FREEZE : SIMPLIFY);
+    }
+}
+
+// --- 四个阶段 ---
+
+void GraphColoringAllocator::simplify() {
+    int n = *m_simplify_worklist.begin();
+    setState(n, SELECTED);
+    m_select_stack.push_back(n);
+    forEachAdjacent(n, [&](int m) { decrementDegree(m); });
+}
+
+void GraphColoringAllocator::addWorkList(int u) {
+    if (m_state[u] != PRECOLORED && !moveRelated(u) && m_degree[u] < m_k) {
+        setState(u, SIMPLIFY);
+    }
+}
+
+// George 测试：t 的每个邻居要么度数低，要么已与 r 干涉
+bool GraphColoringAllocator::ok(int t, int r) const {
+    return m_degree[t] < m_k || m_state[t] == PRECOLORED || adjacent(t, r);
+}
+
+// Briggs 测试：合并后高度数邻居少于 K 个
+bool GraphColoringAllocator::conservative(int u, int v) const {
+    std::unordered_set<int> seen;
+    int k = 0;
+    auto count = [&](int n) {
+        if (seen.insert(n).second && m_degree[n] >= m_k) ++k;
+    };
+    forEachAdjacent(u, count);
+    forEachAdjacent(v, count);
+    return k < m_k;
+}
+
+int GraphColoringAllocator::getAlias(int n) const {
+    while (m_state[n] == COALESCED) n = m_alias[n];
+    return n;
+}
+
+void GraphColoringAllocator::coalesce() {
+    int m = *m_worklist_moves.begin();
+    int x = getAlias(m_moves[m].dst);
+    int y = getAlias(m_moves[m].src);
+    int u = x, v = y;
+    if (m_state[y] == PRECOLORED) {
+        u = y;
+        v = x;
+    }
+
+    if (u == v) {
+        setMoveState(m, MOVE_COALESCED);
+        addWorkList(u);
+    }
+    else if (m_state[v] == PRECOLORED || adjacent(u, v)) {
+        setMoveState(m, MOVE_CONSTRAINED);
+        addWorkList(u);
+        addWorkList(v);
+    }
+    else {
+        bool can_combine;
+        if (m_state[u] == PRECOLORED) {
+            can_combine = true;
+            forEachAdjacent(v, [&](int t) { if (!ok(t, u)) can_combine = false; });
+        }
+        else {
+            can_combine = conservative(u, v);
+        }
+        if (can_combine) {
+            setMoveState(m, MOVE_COALESCED);
+            combine(u, v);
+            addWorkList(u);
+        }
+        else {
+            setMoveState(m, MOVE_ACTIVE);
+        }
+    }
+}
+
+void GraphColoringAllocator::combine(int u, int v) {
+    setState(v, COALESCED);
+    m_alias[v] = u;
+    m_move_list[u].insert(m_move_list[u].end(), m_move_list[v].begin(), m_move_list[v].end());
+    enableMoves(v);
+    forEachAdjacent(v, [&](int t) {
+        addEdge(t, u);
+        decrementDegree(t);
+    });
+    if (m_degree[u] >= m_k && m_state[u] == FREEZE) setState(u, SPILL);
+}
+
+void GraphColoringAllocator::freeze() {
+    int u = *m_freeze_worklist.begin();
+    setState(u, SIMPLIFY);
+    freezeMoves(u);
+}
+
+void GraphColoringAllocator::freezeMoves(int u) {
+    forEachNodeMove(u, [&](int m) {
+        int x = getAlias(m_moves[m].dst);
+        int y = getAlias(m_moves[m].src);
+        int v = (y == getAlias(u)) ? x : y;
+        setMoveState(m, MOVE_FROZEN);
+        if (m_state[v] == FREEZE && !moveRelated(v)) setState(v, SIMPLIFY);
+    });
+}
+
+void GraphColoringAllocator::selectSpill() {
+    int best = -1;
+    double best_cost = 0;
+    for (int n : m_spill_worklist) {
+        double cost = m_spill_cost[n] / std::max(1, m_degree[n]);
+        if (best < 0 || cost < best_cost) {
+            best = n;
+            best_cost = cost;
+        }
+    }
+    setState(best, SIMPLIFY);
+    freezeMoves(best);
+}
+
+void GraphColoringAllocator::assignColors() {
+    while (!m_select_stack.empty()) {
+        int n = m_select_stack.back();
+        m_select_stack.pop_back();
+
+        std::vector<bool> ok_colors(m_k, true);
+        for (int w : m_adj_list[n]) {
+            int a = getAlias(w);
+            if (m_state[a] == COLORED || m_state[a] == PRECOLORED) ok_colors[m_color[a]] = false;
+        }
+        auto it = std::find(ok_colors.begin(), ok_colors.end(), true);
+        if (it == ok_colors.end()) {
+            m_state[n] = SPILLED;
+        }
+        else {
+            m_state[n] = COLORED;
+            m_color[n] = (int)(it - ok_colors.begin());
+        }
+    }
+    for (int n = 0; n < m_num_values; ++n) {
+        if (m_state[n] == COALESCED) m_color[n] = m_color[getAlias(n)];
+    }
+}
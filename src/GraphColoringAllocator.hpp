@@ -0,0 +1,69 @@
+#pragma once
+
+#include "RegisterAllocatorBase.hpp"
+#include <set>
+#include <unordered_set>
+
+// 图着色寄存器分配器：Chaitin-Briggs + 迭代寄存器合并 (George & Appel)
+// 在干涉图上交替执行 simplify / coalesce / freeze / spill，
+// 把 ASSIGN 两端不干涉的 VAR/TEMP 合并到同一个寄存器里，使复制指令消失。
+// 调用会破坏 t3-t6（叶函数里还有空着的 a 寄存器）：它们作为预着色结点，与所有跨调用活跃的值干涉。
+// 溢出代价按循环深度加权（每层 x10），除以度数后取最小者溢出；
+// 溢出的值直接放在栈槽中，由代码生成器用 t0-t2 装载，因此不需要重写后重来。
+class GraphColoringAllocator : public RegisterAllocatorBase {
+protected:
+    void assignRegisters(const FunctionIR& func) override;
+
+private:
+    enum NodeState { PRECOLORED, INITIAL, SIMPLIFY, FREEZE, SPILL, SPILLED, COALESCED, COLORED, SELECTED };
+    enum MoveState { MOVE_WORKLIST, MOVE_ACTIVE, MOVE_COALESCED, MOVE_CONSTRAINED, MOVE_FROZEN };
+    struct Move { int dst; int src; };
+
+    void build(const FunctionIR& func);
+    void computeSpillCosts(const FunctionIR& func);
+    void makeWorklist();
+    void simplify();
+    void coalesce();
+    void freeze();
+    void selectSpill();
+    void assignColors();
+
+    void addEdge(int u, int v);
+    bool adjacent(int u, int v) const;
+    template<class F> void forEachAdjacent(int n, F f) const;
+    template<class F> void forEachNodeMove(int n, F f) const;
+    bool moveRelated(int n) const;
+    void decrementDegree(int m);
+    void enableMoves(int n);
+    void addWorkList(int u);
+    bool ok(int t, int r) const;
+    bool conservative(int u, int v) const;
+    int getAlias(int n) const;
+    void combine(int u, int v);
+    void freezeMoves(int u);
+    void setState(int n, NodeState s);
+    void setMoveState(int m, MoveState s);
+
+    int m_k = 0;          // 可用颜色数
+    int m_num_values = 0; // 结点 [0, m_num_values) 是值，其后是预着色结点
+    std::vector<PhysReg> m_colors;
+
+    std::unordered_set<long long> m_adj_set;
+    std::vector<std::vector<int>> m_adj_list;
+    std::vector<int> m_degree;
+    std::vector<NodeState> m_state;
+    std::vector<int> m_alias;
+    std::vector<int> m_color;
+    std::vector<double> m_spill_cost;
+
+    std::vector<Move> m_moves;
+    std::vector<MoveState> m_move_state;
+    std::vector<std::vector<int>> m_move_list;
+
+    std::set<int> m_simplify_worklist;
+    std::set<int> m_freeze_worklist;
+    std::set<int> m_spill_worklist;
+    std::set<int> m_worklist_moves;
+    std::set<int> m_active_moves;
+    std::vector<int> m_select_stack;
+};
@@ -2,27 +2,28 @@
 
 #include "ast.hpp"
 #include "ir.hpp"
+#include <deque>
 #include <map>
 #include <vector>
 #include <string>
 
 /**
  * @class IRGenerator
- * @brief ʹ÷ģʽ AST ַ루IR
+ * @brief 使用访问者模式遍历 AST 并生成三地址码（IR）
  *
- * ฺ𽫾 AST һڴемʾModuleIR
- * ʽ㡢if/whileĹԼá
+ * 这个类负责将经过语义分析的 AST 翻译成一个内存中的中间表示（ModuleIR）。
+ * 它处理表达式计算、控制流（if/while）的构建以及函数调用。
  */
 class IRGenerator : public Visitor {
 public:
     /**
-     * @brief  IR ں
-     * @param root AST ĸڵ
-     * @return ɵ ModuleIR
+     * @brief 生成 IR 的主入口函数
+     * @param root AST 的根节点
+     * @return 构建完成的整个程序的 ModuleIR
      */
     ModuleIR generate(Program* root);
 
-    // --- ʵ Visitor ӿ ---
+    // --- 实现 Visitor 接口 ---
     void visit(Program* node) override;
     void visit(FuncDef* node) override;
     void visit(Param* node) override;
@@ -42,27 +43,34 @@ public:
     void visit(CallExpr* node) override;
 
 private:
-    // --- ״̬ ---
-    ModuleIR m_module;                      // ڹ IR
-    FunctionIR* current_func = nullptr;   // ָǰڴĺ IR
-    BasicBlock* current_block = nullptr;  // ָǰָĻ
+    // --- 状态管理 ---
+    ModuleIR m_module;                      // 正在构建的整个程序的 IR
+    FunctionIR* current_func = nullptr;   // 指向当前正在处理的函数 IR
+    BasicBlock* current_block = nullptr;  // 指向当前正在填充指令的基本块
 
-    // ڱʽڸӽڵ䴫ݽ
+    // 当前函数的块在生成期间放在 deque 里：追加不会移动已有的块，create_block 返回的指针
+    // 在整个函数生成期间有效，不必复制。m_layout 记录 add_block 的顺序，
+    // 函数结束时按这个顺序把块移进 FunctionIR::blocks
+    std::deque<BasicBlock> m_block_pool;
+    std::vector<BasicBlock*> m_layout;
+
+    // 用于表达式计算后，在父子节点间传递结果操作数
     Operand m_result_op;
 
-    // ջṹڴǶѭ break  continue תĿ
+    // 栈结构，用于处理嵌套循环中 break 和 continue 的跳转目标
     std::vector<Operand> break_labels;
     std::vector<Operand> continue_labels;
 
-    // ---  ---
-    int temp_counter = 0;   // ʱΨһ ID 
-    int label_counter = 0;  // ǩΨһ ID 
+    // --- 辅助函数 ---
+    int temp_counter = 0;   // 临时变量的唯一 ID 计数器
+    int label_counter = 0;  // 基本块标签的唯一 ID 计数器
 
-    Operand new_temp();      // һµʱ
-    Operand new_label_op();  // һµıǩתָ
-    BasicBlock* create_block(const std::string& prefix = ".L"); // һµġĻ
-    void add_block(BasicBlock* bb); // һӵǰΪǰ
+    Operand new_temp();      // 创建一个新的临时变量操作数
+    Operand new_label_op();  // 创建一个新的标签操作数，用于跳转指令
+    BasicBlock* create_block(const std::string& prefix = ".L"); // 创建一个新的、独立的基本块
+    void add_block(BasicBlock* bb); // 将一个块添加到当前函数，并设为当前活动块
+    void finish_blocks();           // 把生成好的块按布局顺序移进当前函数
 
-    //  AST ĶԪöӳ䵽 IR  OpCode ö
+    // 将 AST 的二元操作符枚举映射到 IR 的 OpCode 枚举
     Instruction::OpCode map_bin_op(BinOp op);
 };
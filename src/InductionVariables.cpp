@@ -0,0 +1,203 @@
+#include "InductionVariables.hpp"
+#include "CFG.hpp"
+#include "Liveness.hpp"
+#include <cstdint>
+
+namespace {
+
+int wrap_mul(int a, int b) {
+    return (int)((unsigned)a * (unsigned)b);
+}
+
+int wrap_neg(int a) {
+    return (int)(0u - (unsigned)a);
+}
+
+} // namespace
+
+bool InductionVariables::isInvariant(const Operand& op) const {
+    if (op.kind == Operand::CONST) return true;
+    if (!is_value(op)) return false;
+    auto it = m_def_block.find(Liveness::keyOf(op));
+    return it == m_def_block.end() || !m_loops->contains(m_loop, it->second);
+}
+
+const DerivedIV* InductionVariables::find(const Operand& op) const {
+    if (!is_value(op)) return nullptr;
+    auto it = m_index.find(Liveness::keyOf(op));
+    return it == m_index.end() ? nullptr : &m_derived[it->second];
+}
+
+void InductionVariables::compute(const FunctionIR& func, const LoopInfo& loops, int l) {
+    m_func = &func;
+    m_loops = &loops;
+    m_loop = l;
+    m_latch = -1;
+    m_def_block.clear();
+    m_basics.clear();
+    m_derived.clear();
+    m_index.clear();
+
+    std::unordered_map<ValueKey, InstrRef> def_at;
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        const auto& instrs = func.blocks[b].instructions;
+        for (int i = 0; i < (int)instrs.size(); ++i) {
+            if (const Operand* def = instr_def(instrs[i])) {
+                m_def_block[Liveness::keyOf(*def)] = b;
+                def_at[Liveness::keyOf(*def)] = { b, i };
+            }
+        }
+    }
+
+    const Loop& loop = loops.loop(l);
+    if (loop.latches.size() != 1) return;
+    m_latch = loop.latches[0];
+    const Symbol latch_label = func.blocks[m_latch].label;
+
+    // 1. 基本归纳变量：header 中两个实参的 PHI，回边上的值（穿过复制）是 phi +/- 常量
+    const auto& header = func.blocks[loop.header].instructions;
+    for (int i = 0; i < (int)header.size() && header[i].opcode == Instruction::PHI; ++i) {
+        const Instruction& phi = header[i];
+        if (phi.phi_args.size() != 2) continue;
+        const int back = phi.phi_args[0].block == latch_label ? 0 : 1;
+        if (phi.phi_args[back].block != latch_label || phi.phi_args[1 - back].block == latch_label) continue;
+
+        BasicIV iv;
+        iv.phi = phi.result;
+        iv.init = phi.phi_args[1 - back].value;
+        iv.next = phi.phi_args[back].value;
+        iv.phi_def = { loop.header, i };
+        if (!is_value(iv.next) || iv.init.kind == Operand::NONE) continue;
+
+        // 沿复制找到真正的更新
+        Operand cur = iv.next;
+        const Instruction* update = nullptr;
+        for (int hops = 0; hops < 8; ++hops) {
+            auto it = def_at.find(Liveness::keyOf(cur));
+            if (it == def_at.end() || !loops.contains(l, it->second.block)) break;
+            const Instruction& d = func.blocks[it->second.block].instructions[it->second.index];
+            if (d.opcode == Instruction::ASSIGN && is_value(d.arg1)) {
+                cur = d.arg1;
+                continue;
+            }
+            update = &d;
+            break;
+        }
+        if (!update) continue;
+        if (update->opcode == Instruction::ADD && same_value(update->arg1, iv.phi) && update->arg2.kind == Operand::CONST) {
+            iv.step = update->arg2.value;
+        }
+        else if (update->opcode == Instruction::ADD && same_value(update->arg2, iv.phi) && update->arg1.kind == Operand::CONST) {
+            iv.step = update->arg1.value;
+        }
+        else if (update->opcode == Instruction::SUB && same_value(update->arg1, iv.phi) && update->arg2.kind == Operand::CONST) {
+            iv.step = wrap_neg(update->arg2.value);
+        }
+        else {
+            continue;
+        }
+
+        DerivedIV self;
+        self.value = iv.phi;
+        self.biv = (int)m_basics.size();
+        self.def = iv.phi_def;
+        m_index[Liveness::keyOf(iv.phi)] = (int)m_derived.size();
+        m_derived.push_back(self);
+        m_basics.push_back(iv);
+    }
+    if (m_basics.empty()) return;
+
+    // 2. 派生归纳变量：按逆后序（定值先于使用）扫描循环中的运算
+    for (int b : func.cfg.rpo) {
+        if (!loops.contains(l, b)) continue;
+        const auto& instrs = func.blocks[b].instructions;
+        for (int i = 0; i < (int)instrs.size(); ++i) {
+            const Instruction& instr = instrs[i];
+            if (!is_value(instr.result)) continue;
+            const DerivedIV* x = find(instr.arg1);
+            const DerivedIV* y = find(instr.arg2);
+
+            DerivedIV d;
+            switch (instr.opcode) {
+            case Instruction::ASSIGN:
+                if (!x) continue;
+                d = *x;
+                break;
+            case Instruction::ADD:
+                if (x && isInvariant(instr.arg2)) d = *x;
+                else if (y && isInvariant(instr.arg1)) d = *y;
+                else continue;
+                break;
+            case Instruction::SUB:
+                if (x && isInvariant(instr.arg2)) d = *x;
+                else if (y && isInvariant(instr.arg1)) {
+                    d = *y;
+                    d.scale = wrap_neg(d.scale);
+                }
+                else continue;
+                break;
+            case Instruction::MUL: {
+                const Operand* k = nullptr;
+                if (x && isInvariant(instr.arg2)) {
+                    d = *x;
+                    k = &instr.arg2;
+                }
+                else if (y && isInvariant(instr.arg1)) {
+                    d = *y;
+                    k = &instr.arg1;
+                }
+                else continue;
+                if (k->kind == Operand::CONST) d.scale = wrap_mul(d.scale, k->value);
+                else if (d.factor.kind == Operand::NONE) d.factor = *k;
+                else continue; // 两个不变量乘数的积需要额外计算，不识别
+                break;
+            }
+            default:
+                continue;
+            }
+            d.value = instr.result;
+            d.def = { b, i };
+            m_index[Liveness::keyOf(instr.result)] = (int)m_derived.size();
+            m_derived.push_back(d);
+        }
+    }
+}
+
+// i 从 init 开始每次加 step，`i OP bound` 成立时继续：算出迭代次数。
+// 中途 i 会越过 32 位范围（程序里会回绕）或者永不结束时返回 false。
+bool trip_count(Instruction::OpCode op, long long init, long long bound, long long step, long long& n) {
+    if (step == 0) return false;
+    switch (op) {
+    case Instruction::LT:
+        if (init >= bound) { n = 0; return true; }
+        if (step < 0) return false;
+        n = (bound - init + step - 1) / step;
+        break;
+    case Instruction::LE:
+        if (init > bound) { n = 0; return true; }
+        if (step < 0) return false;
+        n = (bound - init) / step + 1;
+        break;
+    case Instruction::GT:
+        if (init <= bound) { n = 0; return true; }
+        if (step > 0) return false;
+        n = (init - bound - step - 1) / -step;
+        break;
+    case Instruction::GE:
+        if (init < bound) { n = 0; return true; }
+        if (step > 0) return false;
+        n = (init - bound) / -step + 1;
+        break;
+    case Instruction::EQ:
+        n = init == bound ? 1 : 0;
+        return true;
+    case Instruction::NEQ:
+        if ((bound - init) % step != 0 || (bound - init) / step < 0) return false;
+        n = (bound - init) / step;
+        return true;
+    default:
+        return false;
+    }
+    const long long last = init + n * step; // 让条件不成立的那个值
+    return last >= INT32_MIN && last <= INT32_MAX;
+}
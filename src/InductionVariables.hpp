@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ir.hpp"
+#include "LoopInfo.hpp"
+#include "SSA.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 基本归纳变量：header 中的 PHI，从循环外进入时取 init，每沿回边走一次加上常量 step。
+struct BasicIV {
+    Operand phi;       // header 中 PHI 的结果（本次迭代的值）
+    Operand init;      // 从循环外进入时的值
+    Operand next;      // 回边上的值，等于 phi + step
+    int step = 0;
+    InstrRef phi_def;  // PHI 的位置
+};
+
+// 归纳变量的线性形式：value = scale * factor * phi + offset，其中 phi 是基本归纳变量 biv 本次迭代的值，
+// scale 是常量，factor 是可选的循环不变量（NONE 表示 1），offset 是某个循环不变量（不显式记录）。
+// 基本归纳变量自身是 scale = 1 的派生归纳变量；所有运算都按 32 位回绕计算。
+struct DerivedIV {
+    Operand value;
+    int biv = -1;        // BasicIV 的下标
+    int scale = 1;
+    Operand factor;      // 可选的循环不变量乘数
+    InstrRef def;        // 定值点（基本归纳变量是它的 PHI）
+};
+
+// 单个自然循环的归纳变量（需要 SSA 形式和最新的控制流图）。
+// 只识别只有一条回边的循环；派生归纳变量由 ADD/SUB/MUL/复制从归纳变量和循环不变量组合而来。
+class InductionVariables {
+public:
+    void compute(const FunctionIR& func, const LoopInfo& loops, int l);
+
+    const std::vector<BasicIV>& basics() const { return m_basics; }
+    const std::vector<DerivedIV>& derived() const { return m_derived; }
+    // 循环唯一的回边源，没有唯一回边时为 -1（此时没有任何归纳变量）
+    int latch() const { return m_latch; }
+
+    // 常量，或者在循环外定义的值（包括参数）
+    bool isInvariant(const Operand& op) const;
+    // op 是归纳变量时返回它的线性形式，否则返回 nullptr
+    const DerivedIV* find(const Operand& op) const;
+
+private:
+    const FunctionIR* m_func = nullptr;
+    const LoopInfo* m_loops = nullptr;
+    int m_loop = -1;
+    int m_latch = -1;
+    std::unordered_map<ValueKey, int> m_def_block; // 值 -> 定值所在的块
+    std::vector<BasicIV> m_basics;
+    std::vector<DerivedIV> m_derived;
+    std::unordered_map<ValueKey, int> m_index;     // 值 -> m_derived 的下标
+};
+
+// i 从 init 开始每次加 step，`i OP bound` 成立时继续：算出迭代次数 n。
+// 中途 i 会越过 32 位范围（程序里会回绕）或者永不结束时返回 false
+bool trip_count(Instruction::OpCode op, long long init, long long bound, long long step, long long& n);
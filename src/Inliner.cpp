@@ -0,0 +1,213 @@
+#include "Inliner.hpp"
+#include "CFG.hpp"
+#include "LoopInfo.hpp"
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+const int kAlwaysInlineSize = 12;   // 与 PARAM/CALL、序言和尾声的开销相当
+const int kLoopBonus = 20;          // 每层循环放宽的指令数
+const int kMaxLoopDepthBonus = 3;
+const int kSingleCallSiteSize = 150;
+const int kMaxCallerSize = 600;
+
+int function_size(const FunctionIR& func) {
+    int n = 0;
+    for (const auto& bb : func.blocks) n += reachable_end(bb);
+    return n;
+}
+
+bool calls(const FunctionIR& func, Symbol callee) {
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            if (instr.opcode == Instruction::CALL && instr.arg1.name == callee) return true;
+        }
+    }
+    return false;
+}
+
+// 把 callee 在 caller 的块 b、下标 i 处的调用展开
+void inline_call(FunctionIR& caller, int b, int i, const FunctionIR& callee, int site) {
+    BasicBlock& bb = caller.blocks[b];
+    const Instruction call = bb.instructions[i];
+    const int nargs = call.arg2.value;
+    const std::string suffix = "." + callee.name + std::to_string(site);
+
+    // 1. 切开调用点：前半段保留原标签，调用之后的指令进入续块
+    BasicBlock cont;
+    cont.label = new_block_label(caller, "inline_ret");
+    cont.instructions.assign(bb.instructions.begin() + i + 1, bb.instructions.end());
+    std::vector<Instruction> args(bb.instructions.begin() + i - nargs, bb.instructions.begin() + i);
+    bb.instructions.resize(i - nargs);
+
+    // 2. 改名表
+    std::unordered_map<Symbol, Symbol> vars, labels;
+    std::unordered_map<int, int> temps;
+    for (const auto& callee_bb : callee.blocks) {
+        labels[callee_bb.label] = new_block_label(caller, "inline");
+    }
+    auto rename = [&](Operand& op) {
+        if (op.kind == Operand::VAR) {
+            auto it = vars.find(op.name);
+            if (it == vars.end()) it = vars.emplace(op.name, Symbol::intern(op.name + suffix)).first;
+            op.name = it->second;
+        }
+        else if (op.kind == Operand::TEMP) {
+            auto it = temps.find(op.id);
+            if (it == temps.end()) it = temps.emplace(op.id, make_temp(caller).id).first;
+            op.id = it->second;
+        }
+    };
+
+    // 3. 实参赋给形参；PARAM 从右到左排列，最后一条是第一个实参
+    for (int k = 0; k < nargs && k < (int)callee.params.size(); ++k) {
+        Instruction assign;
+        assign.opcode = Instruction::ASSIGN;
+        assign.result.kind = Operand::VAR;
+        assign.result.name = callee.params[k].name;
+        rename(assign.result);
+        assign.arg1 = args[nargs - 1 - k].arg1;
+        bb.instructions.push_back(assign);
+    }
+
+    // 4. 复制函数体；布局上紧跟调用点，从函数末尾落出时正好落入续块
+    std::vector<BasicBlock> body;
+    for (const auto& callee_bb : callee.blocks) {
+        BasicBlock copy;
+        copy.label = labels[callee_bb.label];
+        const int end = reachable_end(callee_bb);
+        for (int k = 0; k < end; ++k) {
+            Instruction instr = callee_bb.instructions[k];
+            for_each_use(instr, rename);
+            if (Operand* def = instr_def(instr)) rename(*def);
+            if (instr.opcode == Instruction::JUMP) instr.arg1.name = labels[instr.arg1.name];
+            if (instr.opcode == Instruction::JUMP_IF_ZERO || instr.opcode == Instruction::JUMP_IF_NZERO) {
+                instr.arg2.name = labels[instr.arg2.name];
+            }
+            if (instr.opcode == Instruction::RET) {
+                if (is_value(call.result) && instr.arg1.kind != Operand::NONE) {
+                    Instruction assign;
+                    assign.opcode = Instruction::ASSIGN;
+                    assign.result = call.result;
+                    assign.arg1 = instr.arg1;
+                    copy.instructions.push_back(assign);
+                }
+                instr = Instruction();
+                instr.opcode = Instruction::JUMP;
+                instr.arg1.kind = Operand::LABEL;
+                instr.arg1.name = cont.label;
+            }
+            copy.instructions.push_back(instr);
+        }
+        body.push_back(std::move(copy));
+    }
+    body.push_back(std::move(cont));
+    caller.blocks.insert(caller.blocks.begin() + b + 1,
+        std::make_move_iterator(body.begin()), std::make_move_iterator(body.end()));
+    build_cfg(caller);
+}
+
+} // namespace
+
+bool InlinerPass::runOnModule(ModuleIR& module) {
+    std::unordered_map<Symbol, int> index;
+    for (int f = 0; f < (int)module.functions.size(); ++f) index[module.functions[f].name] = f;
+
+    // 全模块的调用点数
+    auto count_sites = [&]() {
+        std::unordered_map<Symbol, int> sites;
+        for (const auto& func : module.functions) {
+            for (const auto& bb : func.blocks) {
+                for (const auto& instr : bb.instructions) {
+                    if (instr.opcode == Instruction::CALL) sites[instr.arg1.name]++;
+                }
+            }
+        }
+        return sites;
+    };
+
+    // 调用图的后序：被调用者先于调用者
+    std::vector<int> order;
+    std::vector<int> state(module.functions.size(), 0);
+    std::function<void(int)> visit = [&](int f) {
+        state[f] = 1;
+        for (const auto& bb : module.functions[f].blocks) {
+            for (const auto& instr : bb.instructions) {
+                if (instr.opcode != Instruction::CALL) continue;
+                auto it = index.find(instr.arg1.name);
+                if (it != index.end() && state[it->second] == 0) visit(it->second);
+            }
+        }
+        order.push_back(f);
+    };
+    for (int f = 0; f < (int)module.functions.size(); ++f) {
+        if (state[f] == 0) visit(f);
+    }
+
+    bool changed = false;
+    int site_counter = 0;
+    for (int f : order) {
+        FunctionIR& caller = module.functions[f];
+        std::unordered_map<Symbol, int> sites = count_sites();
+        for (;;) {
+            build_cfg(caller);
+            LoopInfo loops;
+            loops.compute(caller);
+            const int caller_size = function_size(caller);
+
+            int site_block = -1, site_index = -1, callee_index = -1;
+            for (int b = 0; b < (int)caller.blocks.size() && site_block < 0; ++b) {
+                if (!is_reachable(caller, b)) continue;
+                const auto& instrs = caller.blocks[b].instructions;
+                for (int i = 0; i < reachable_end(caller.blocks[b]); ++i) {
+                    if (instrs[i].opcode != Instruction::CALL) continue;
+                    auto it = index.find(instrs[i].arg1.name);
+                    if (it == index.end() || it->second == f) continue;
+                    const FunctionIR& callee = module.functions[it->second];
+                    if (callee.name.str() == "main" || calls(callee, callee.name)) continue;
+                    // PARAM 必须紧挨着 CALL
+                    const int nargs = instrs[i].arg2.value;
+                    bool params_ok = nargs <= i && nargs == (int)callee.params.size();
+                    for (int k = i - nargs; params_ok && k < i; ++k) {
+                        params_ok = instrs[k].opcode == Instruction::PARAM;
+                    }
+                    if (!params_ok) continue;
+
+                    const int size = function_size(callee);
+                    if (caller_size + size > kMaxCallerSize) continue;
+                    const int depth = std::min(loops.depth(b), kMaxLoopDepthBonus);
+                    bool inline_it = size <= kAlwaysInlineSize + kLoopBonus * depth ||
+                        (sites[callee.name] == 1 && size <= kSingleCallSiteSize);
+                    if (!inline_it) continue;
+                    site_block = b;
+                    site_index = i;
+                    callee_index = it->second;
+                    break;
+                }
+            }
+            if (site_block < 0) break;
+
+            const FunctionIR callee = module.functions[callee_index]; // 复制一份，caller 会被修改
+            inline_call(caller, site_block, site_index, callee, site_counter++);
+            sites[callee.name]--;
+            changed = true;
+        }
+    }
+
+    // 删除不再被调用的函数
+    for (bool removed = true; removed;) {
+        removed = false;
+        std::unordered_map<Symbol, int> sites = count_sites();
+        for (auto it = module.functions.begin(); it != module.functions.end(); ++it) {
+            if (it->name.str() != "main" && sites[it->name] == 0) {
+                module.functions.erase(it);
+                removed = changed = true;
+                break;
+            }
+        }
+    }
+    return changed;
+}
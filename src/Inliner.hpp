@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class InlinerPass
+ * @brief 函数内联
+ *
+ * 在 SSA 构造之前运行。按调用图自底向上处理函数（被调用者先于调用者），
+ * 把满足代价模型的调用点换成被调用函数体的副本：VAR/TEMP/标签全部改名，
+ * 实参赋给改名后的形参，RET 变成“写结果 + 跳到调用点之后的续块”。
+ *
+ * 代价模型以指令条数为预算：
+ *   - 很小的函数（不超过一次调用本身的开销）总是内联；
+ *   - 调用点在循环里时按循环深度放宽上限（执行次数越多，省下的调用开销越多）；
+ *   - 全模块只有一个调用点的函数，内联后原函数可以删掉，允许更大；
+ *   - 调用者内联后的大小不超过上限；直接递归的函数不内联。
+ * 最后删除不再被调用的函数（main 除外）。
+ */
+class InlinerPass : public Pass {
+public:
+    const char* name() const override { return "inline"; }
+    bool runOnModule(ModuleIR& module) override;
+};
@@ -0,0 +1,109 @@
+#include "LICM.hpp"
+#include "LoopInfo.hpp"
+#include "CFG.hpp"
+#include "Liveness.hpp"
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+bool is_pure(const Instruction& instr) {
+    switch (instr.opcode) {
+    case Instruction::ADD: case Instruction::SUB: case Instruction::MUL: case Instruction::DIV: case Instruction::MOD:
+    case Instruction::NOT: case Instruction::EQ: case Instruction::NEQ: case Instruction::LT: case Instruction::GT:
+    case Instruction::LE: case Instruction::GE: case Instruction::ASSIGN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 找出循环 l 中的不变量，按执行顺序返回 (块, 下标)
+std::vector<std::pair<int, int>> find_invariants(const FunctionIR& func, const LoopInfo& loops, int l) {
+    std::unordered_map<ValueKey, int> def_block;
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        for (const auto& instr : func.blocks[b].instructions) {
+            if (const Operand* def = instr_def(instr)) def_block[Liveness::keyOf(*def)] = b;
+        }
+    }
+
+    std::vector<std::pair<int, int>> result;
+    std::unordered_set<ValueKey> invariant;
+    for (int b : func.cfg.rpo) { // 逆后序保证定值先于使用
+        if (!loops.contains(l, b)) continue;
+        const auto& instrs = func.blocks[b].instructions;
+        for (int i = 0; i < (int)instrs.size(); ++i) {
+            if (!is_pure(instrs[i])) continue;
+            bool ok = true;
+            for_each_use(instrs[i], [&](const Operand& op) {
+                ValueKey key = Liveness::keyOf(op);
+                auto it = def_block.find(key);
+                bool outside = it == def_block.end() || !loops.contains(l, it->second);
+                if (!outside && !invariant.count(key)) ok = false;
+            });
+            if (!ok) continue;
+            invariant.insert(Liveness::keyOf(instrs[i].result));
+            result.push_back({ b, i });
+        }
+    }
+    return result;
+}
+
+int find_loop(const FunctionIR& func, const LoopInfo& loops, Symbol header) {
+    for (int l = 0; l < (int)loops.loops().size(); ++l) {
+        if (func.blocks[loops.loop(l).header].label == header) return l;
+    }
+    return -1;
+}
+
+} // namespace
+
+bool LICMPass::runOnFunction(FunctionIR& func) {
+    if (!func.in_ssa) return false;
+    bool changed = false;
+    std::set<Symbol> done; // 已处理循环的 header 标签（插入前置块会改变块 id）
+    LoopInfo loops;
+
+    for (;;) {
+        loops.compute(func);
+        int l = -1;
+        for (int i = 0; i < (int)loops.loops().size(); ++i) {
+            if (!done.count(func.blocks[loops.loop(i).header].label)) {
+                l = i;
+                break;
+            }
+        }
+        if (l < 0) break;
+        const Symbol header = func.blocks[loops.loop(l).header].label;
+        done.insert(header);
+
+        if (find_invariants(func, loops, l).empty()) continue;
+        if (loops.loop(l).preheader < 0) {
+            insert_preheader(func, loops, l);
+            loops.compute(func);
+            l = find_loop(func, loops, header);
+        }
+        const auto invariants = find_invariants(func, loops, l);
+
+        // 按原顺序移到前置块末尾的跳转之前
+        std::vector<Instruction> hoisted;
+        std::set<std::pair<int, int>> moved(invariants.begin(), invariants.end());
+        for (const auto& ref : invariants) {
+            hoisted.push_back(func.blocks[ref.first].instructions[ref.second]);
+        }
+        for (int b : loops.loop(l).blocks) {
+            auto& instrs = func.blocks[b].instructions;
+            std::vector<Instruction> kept;
+            for (int i = 0; i < (int)instrs.size(); ++i) {
+                if (!moved.count({ b, i })) kept.push_back(std::move(instrs[i]));
+            }
+            instrs = std::move(kept);
+        }
+        auto& pre = func.blocks[loops.loop(l).preheader].instructions;
+        auto pos = (!pre.empty() && jump_target(pre.back())) ? pre.end() - 1 : pre.end();
+        pre.insert(pos, hoisted.begin(), hoisted.end());
+        changed = true;
+    }
+    return changed;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class LICMPass
+ * @brief 循环不变量外提
+ *
+ * 在 SSA 形式上按自然循环从内到外处理：操作数都是常量、循环外定义的值
+ * 或已经外提的值的纯运算（算术、比较、NOT、复制）是循环不变量，
+ * 把它们按原来的顺序移到循环的前置块末尾（没有前置块时先插入一个）。
+ * 内层外提到的前置块属于外层循环，外层处理时还能继续往外提。
+ * RISC-V 的除法不会因除数为 0 而陷入，所以即使条件分支里的 DIV/MOD 也可以提前计算。
+ */
+class LICMPass : public FunctionPass {
+public:
+    const char* name() const override { return "licm"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
@@ -0,0 +1,125 @@
+#include "LinearScanAllocator.hpp"
+#include <algorithm>
+#include <climits>
+
+void LinearScanAllocator::buildIntervals(const FunctionIR& func) {
+    const int nv = m_liveness.numValues();
+    std::vector<int> start(nv, INT_MAX), end(nv, -1);
+    auto extend = [&](int v, int pos) {
+        if (v < 0) return;
+        start[v] = std::min(start[v], pos);
+        end[v] = std::max(end[v], pos);
+    };
+
+    // 参数在函数入口处定义
+    for (const auto& param : func.params) {
+        Operand op;
+        op.kind = Operand::VAR;
+        op.name = param.name;
+        extend(m_liveness.indexOf(op), 0);
+    }
+
+    std::vector<int> call_positions;
+    for (int b = 0; b < m_liveness.numBlocks(); ++b) {
+        const auto& instrs = func.blocks[b].instructions;
+        const int first = m_liveness.blockStart(b);
+        const int last = std::max(first, m_liveness.blockEnd(b));
+        m_liveness.liveIn(b).forEach([&](int v) { extend(v, first); });
+        m_liveness.liveOut(b).forEach([&](int v) { extend(v, last); });
+
+        // PARAM 的实参在随后的 CALL 处才装入 a0-a7，所以它的使用点算在 CALL 上
+        int next_call = -1;
+        for (int i = (int)instrs.size() - 1; i >= 0; --i) {
+            const int pos = m_liveness.position(b, i);
+            const Instruction& instr = instrs[i];
+            if (instr.opcode == Instruction::CALL) {
+                next_call = pos;
+                call_positions.push_back(pos);
+            }
+            if (instr.opcode == Instruction::TAIL_CALL) next_call = pos; // 之后没有值活跃，不算跨调用
+            if (const Operand* def = instr_def(instr)) extend(m_liveness.indexOf(*def), pos);
+            const int use_pos = (instr.opcode == Instruction::PARAM && next_call >= 0) ? next_call : pos;
+            for_each_use(instr, [&](const Operand& op) { extend(m_liveness.indexOf(op), use_pos); });
+        }
+    }
+    std::sort(call_positions.begin(), call_positions.end());
+
+    m_intervals.clear();
+    for (int v = 0; v < nv; ++v) {
+        if (end[v] < 0 || isFolded(v)) continue;
+        Interval it;
+        it.value = v;
+        it.start = start[v];
+        it.end = end[v];
+        // 区间内部（不含两个端点）有调用，说明值在调用前后都活跃
+        auto c = std::upper_bound(call_positions.begin(), call_positions.end(), it.start);
+        it.crosses_call = (c != call_positions.end() && *c < it.end);
+        m_intervals.push_back(it);
+    }
+    std::sort(m_intervals.begin(), m_intervals.end(), [](const Interval& a, const Interval& b) {
+        return a.start != b.start ? a.start < b.start : a.value < b.value;
+    });
+}
+
+void LinearScanAllocator::allocate() {
+    // 空闲寄存器池，末尾先出
+    std::vector<PhysReg> free_caller(callerSavedRegs().rbegin(), callerSavedRegs().rend());
+    std::vector<PhysReg> free_callee(calleeSavedRegs().rbegin(), calleeSavedRegs().rend());
+    std::vector<Interval*> active; // 按 end 升序
+
+    auto release = [&](PhysReg reg) {
+        if (isCalleeSaved(reg)) free_callee.push_back(reg);
+        else free_caller.push_back(reg);
+    };
+    auto add_active = [&](Interval* it) {
+        auto pos = std::upper_bound(active.begin(), active.end(), it,
+            [](const Interval* a, const Interval* b) { return a->end < b->end; });
+        active.insert(pos, it);
+    };
+
+    for (auto& cur : m_intervals) {
+        // 1. 释放已经结束的区间
+        while (!active.empty() && active.front()->end < cur.start) {
+            release(active.front()->reg);
+            active.erase(active.begin());
+        }
+
+        // 2. 有空闲寄存器就直接分配
+        if (!cur.crosses_call && !free_caller.empty()) {
+            cur.reg = free_caller.back();
+            free_caller.pop_back();
+            add_active(&cur);
+            continue;
+        }
+        if (!free_callee.empty()) {
+            cur.reg = free_callee.back();
+            free_callee.pop_back();
+            add_active(&cur);
+            continue;
+        }
+
+        // 3. 寄存器不够：在可用的活跃区间里找结束最晚的一个，比当前区间更晚就抢占它
+        Interval* victim = nullptr;
+        for (auto it = active.rbegin(); it != active.rend(); ++it) {
+            if (!cur.crosses_call || isCalleeSaved((*it)->reg)) {
+                victim = *it;
+                break;
+            }
+        }
+        if (victim && victim->end > cur.end) {
+            cur.reg = victim->reg;
+            victim->reg = NO_REG;
+            active.erase(std::find(active.begin(), active.end(), victim));
+            add_active(&cur);
+        }
+        // 否则当前区间溢出，reg 保持为 NO_REG
+    }
+}
+
+void LinearScanAllocator::assignRegisters(const FunctionIR& func) {
+    buildIntervals(func);
+    allocate();
+    for (const auto& it : m_intervals) {
+        m_assigned[it.value] = it.reg;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "RegisterAllocatorBase.hpp"
+
+// 线性扫描寄存器分配器 (Poletto & Sarkar)
+// 求出每个 VAR/TEMP 的活跃区间，按起点依次分配 t3-t6 / s0-s11（叶函数还有空着的 a 寄存器），
+// 只有寄存器不够时才把结束最晚的区间溢出到栈上。
+class LinearScanAllocator : public RegisterAllocatorBase {
+protected:
+    void assignRegisters(const FunctionIR& func) override;
+
+private:
+    struct Interval {
+        int value;          // Liveness 中的值下标
+        int start;
+        int end;
+        bool crosses_call;  // 跨越调用的区间只能放进被调用者保存寄存器
+        PhysReg reg = NO_REG; // 分配结果；NO_REG 表示溢出
+    };
+
+    void buildIntervals(const FunctionIR& func);
+    void allocate();
+
+    std::vector<Interval> m_intervals;
+};
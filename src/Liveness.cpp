@@ -0,0 +1,172 @@
+#include "Liveness.hpp"
+#include "CFG.hpp"
+
+// --- LiveSet ---
+
+void LiveSet::set(int i) {
+    const uint32_t index = (uint32_t)i >> 6;
+    const size_t w = find(index);
+    if (w < m_words.size() && m_words[w].index == index) m_words[w].bits |= (uint64_t)1 << (i & 63);
+    else m_words.insert(m_words.begin() + w, Word{ index, (uint64_t)1 << (i & 63) });
+}
+
+void LiveSet::reset(int i) {
+    const uint32_t index = (uint32_t)i >> 6;
+    const size_t w = find(index);
+    if (w == m_words.size() || m_words[w].index != index) return;
+    m_words[w].bits &= ~((uint64_t)1 << (i & 63));
+    if (m_words[w].bits == 0) m_words.erase(m_words.begin() + w);
+}
+
+// 原地归并：先把空间扩到两者之和，从尾部往前按字号归并（字号相同的字做或运算），
+// 结果落在末尾一段，再整体移到开头
+void LiveSet::unionWith(const LiveSet& other) {
+    if (other.m_words.empty()) return;
+    const size_t n = m_words.size(), m = other.m_words.size();
+    m_words.resize(n + m);
+    size_t i = n, j = m, k = n + m;
+    while (j > 0) {
+        const Word& b = other.m_words[j - 1];
+        if (i > 0 && m_words[i - 1].index > b.index) {
+            m_words[--k] = m_words[--i];
+        }
+        else if (i > 0 && m_words[i - 1].index == b.index) {
+            m_words[--k] = Word{ b.index, m_words[--i].bits | b.bits };
+            --j;
+        }
+        else {
+            m_words[--k] = b;
+            --j;
+        }
+    }
+    // 剩下的 [0, i) 本来就在最前面且有序，只需把 [k, n + m) 接在它后面
+    if (k > i) {
+        std::copy(m_words.begin() + k, m_words.end(), m_words.begin() + i);
+        m_words.resize(i + (n + m - k));
+    }
+}
+
+bool LiveSet::operator==(const LiveSet& other) const {
+    if (m_words.size() != other.m_words.size()) return false;
+    for (size_t w = 0; w < m_words.size(); ++w) {
+        if (m_words[w].index != other.m_words[w].index || m_words[w].bits != other.m_words[w].bits) return false;
+    }
+    return true;
+}
+
+// --- Liveness ---
+
+int Liveness::indexOf(const Operand& op) const {
+    if (!is_value(op)) return -1;
+    auto it = m_index.find(keyOf(op));
+    return it == m_index.end() ? -1 : it->second;
+}
+
+int Liveness::addValue(const Operand& op) {
+    auto inserted = m_index.emplace(keyOf(op), (int)m_values.size());
+    if (inserted.second) m_values.push_back(op);
+    return inserted.first->second;
+}
+
+void Liveness::compute(const FunctionIR& func) {
+    m_index.clear();
+    m_values.clear();
+    const int n = (int)func.blocks.size();
+
+    // 1. 值编号：参数在前，其余按出现顺序
+    for (const auto& param : func.params) {
+        Operand op;
+        op.kind = Operand::VAR;
+        op.name = param.name;
+        addValue(op);
+    }
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            if (const Operand* def = instr_def(instr)) addValue(*def);
+            for_each_use(instr, [&](const Operand& op) { addValue(op); });
+        }
+    }
+    const int nv = (int)m_values.size();
+
+    // 2. 线性位置；块的边来自控制流图
+    m_func = &func;
+    m_block_start.assign(n + 1, 0);
+    m_reachable_end.assign(n, 0);
+    for (int b = 0; b < n; ++b) {
+        m_block_start[b + 1] = m_block_start[b] + (int)func.blocks[b].instructions.size();
+        m_reachable_end[b] = reachable_end(func.blocks[b]);
+    }
+
+    // 3. 迭代求解 live-in，直到不动点
+    m_live_in.assign(n, LiveSet(nv));
+    m_live_out.assign(n, LiveSet(nv));
+    // 按后序（逆 RPO）迭代收敛最快；不可达的块放在最后
+    std::vector<int> order(func.cfg.rpo.rbegin(), func.cfg.rpo.rend());
+    for (int b = 0; b < n; ++b) {
+        if (!is_reachable(func, b)) order.push_back(b);
+    }
+    // live 在各块之间复用；与 live-in 不同时交换，不为每个块重新分配
+    LiveSet live(nv);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b : order) {
+            const auto& instrs = func.blocks[b].instructions;
+            liveAfterBlock(func, b, live);
+            for (int i = m_reachable_end[b] - 1; i >= 0; --i) {
+                transfer(instrs[i], live);
+            }
+            if (live != m_live_in[b]) {
+                m_live_in[b].swap(live);
+                changed = true;
+            }
+        }
+    }
+
+    for (int b = 0; b < n; ++b) {
+        for (int s : func.blocks[b].succs) m_live_out[b].unionWith(m_live_in[s]);
+    }
+}
+
+void Liveness::unionLiveIn(Symbol label, LiveSet& live) const {
+    int b = find_block(*m_func, label);
+    if (b >= 0) live.unionWith(m_live_in[b]);
+}
+
+// 块末尾之后的活跃集合：取决于最后一条可执行指令
+void Liveness::liveAfterBlock(const FunctionIR& func, int b, LiveSet& live) const {
+    const auto& instrs = func.blocks[b].instructions;
+    const int end = m_reachable_end[b];
+    live.clear();
+    if (end > 0 && instrs[end - 1].opcode == Instruction::JUMP) {
+        unionLiveIn(instrs[end - 1].arg1.name, live);
+    }
+    else if (end == 0 || !is_return(instrs[end - 1])) {
+        if (b + 1 < (int)m_live_in.size()) live.unionWith(m_live_in[b + 1]);
+    }
+}
+
+// 把“指令之后”的活跃集合变换为“指令之前”的
+void Liveness::transfer(const Instruction& instr, LiveSet& live) const {
+    // 条件跳转处，跳转目标的 live-in 也是活跃的
+    if (instr.opcode == Instruction::JUMP_IF_ZERO || instr.opcode == Instruction::JUMP_IF_NZERO) {
+        unionLiveIn(instr.arg2.name, live);
+    }
+    if (const Operand* def = instr_def(instr)) live.reset(indexOf(*def));
+    for_each_use(instr, [&](const Operand& op) { live.set(indexOf(op)); });
+}
+
+void Liveness::walkBlockBackward(const FunctionIR& func, int b,
+    const std::function<void(int, const LiveSet&)>& f) const {
+    const auto& instrs = func.blocks[b].instructions;
+    LiveSet live(numValues());
+    liveAfterBlock(func, b, live);
+    for (int i = m_reachable_end[b] - 1; i >= 0; --i) {
+        // 条件跳转之后的活跃集合还要并上跳转目标的 live-in
+        if (instrs[i].opcode == Instruction::JUMP_IF_ZERO || instrs[i].opcode == Instruction::JUMP_IF_NZERO) {
+            unionLiveIn(instrs[i].arg2.name, live);
+        }
+        f(i, live);
+        transfer(instrs[i], live);
+    }
+}
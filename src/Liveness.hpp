@@ -0,0 +1,120 @@
+#pragma once
+
+#include "ir.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 值下标的集合，按 64 位字压缩存放，而且只存非零的字（字号 + 该字的位，按字号排序）。
+// 大函数里每个块入口活跃的值通常只有几个，稠密的位向量会让内存随“块数 × 值数”增长；
+// 这里内存只与实际活跃的值有关。并集按字归并，一次处理一个字，不分配新的集合；
+// forEach 只访问置位的下标
+class LiveSet {
+public:
+    LiveSet() = default;
+    explicit LiveSet(int n) : m_size(n) {}
+
+    // 下标的范围 [0, size())
+    int size() const { return m_size; }
+    bool operator[](int i) const {
+        const size_t w = find((uint32_t)i >> 6);
+        return w < m_words.size() && m_words[w].index == ((uint32_t)i >> 6) && ((m_words[w].bits >> (i & 63)) & 1);
+    }
+    void set(int i);
+    void reset(int i);
+    void clear() { m_words.clear(); }
+    void unionWith(const LiveSet& other);
+    bool operator==(const LiveSet& other) const;
+    bool operator!=(const LiveSet& other) const { return !(*this == other); }
+    void swap(LiveSet& other) { m_words.swap(other.m_words); std::swap(m_size, other.m_size); }
+
+    // 按下标从小到大对每个元素调用 f(i)
+    template<class F>
+    void forEach(F f) const {
+        for (const auto& word : m_words) {
+            for (uint64_t bits = word.bits; bits != 0; bits &= bits - 1) {
+                f((int)(word.index * 64 + lowest_bit(bits)));
+            }
+        }
+    }
+
+private:
+    struct Word {
+        uint32_t index;
+        uint64_t bits;
+    };
+
+    // 第一个字号不小于 index 的位置
+    size_t find(uint32_t index) const {
+        return std::lower_bound(m_words.begin(), m_words.end(), index,
+            [](const Word& w, uint32_t i) { return w.index < i; }) - m_words.begin();
+    }
+
+    static int lowest_bit(uint64_t x) {
+#ifdef _MSC_VER
+        unsigned long bit;
+        _BitScanForward64(&bit, x);
+        return (int)bit;
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    std::vector<Word> m_words;
+    int m_size = 0;
+};
+
+// 函数级活跃变量分析，供寄存器分配器使用。
+// 把函数里出现的 VAR/TEMP 编号为稠密下标，沿控制流图（需先 build_cfg）迭代求 live-in/live-out，
+// 并按块的布局顺序给每条指令一个线性位置。
+class Liveness {
+public:
+    void compute(const FunctionIR& func);
+
+    // --- 值编号 ---
+    int numValues() const { return (int)m_values.size(); }
+    int indexOf(const Operand& op) const; // 不是 VAR/TEMP 时返回 -1
+    const Operand& valueAt(int idx) const { return m_values[idx]; }
+
+    // --- 块信息 ---
+    int numBlocks() const { return (int)m_reachable_end.size(); }
+    const std::vector<int>& succs(int b) const { return m_func->blocks[b].succs; }
+    // 块内可执行部分的长度：第一条无条件跳转/RET 之后的指令永远不会执行
+    int reachableEnd(int b) const { return m_reachable_end[b]; }
+    const LiveSet& liveIn(int b) const { return m_live_in[b]; }
+    const LiveSet& liveOut(int b) const { return m_live_out[b]; }
+
+    // 块 b 第 i 条指令的线性位置；块的位置区间为 [blockStart(b), blockStart(b + 1))
+    int position(int b, int i) const { return m_block_start[b] + i; }
+    int blockStart(int b) const { return m_block_start[b]; }
+    int blockEnd(int b) const { return m_block_start[b + 1] - 1; }
+
+    // 逆序遍历块 b 的可执行指令，对每条指令调用 f(i, live)，live 为该指令执行之后的活跃集合
+    void walkBlockBackward(const FunctionIR& func, int b,
+        const std::function<void(int, const LiveSet&)>& f) const;
+
+    static ValueKey keyOf(const Operand& op) { return value_key(op); }
+
+private:
+    int addValue(const Operand& op);
+    // 把块 b 末尾之后的活跃集合写进 live（原有内容被覆盖）
+    void liveAfterBlock(const FunctionIR& func, int b, LiveSet& live) const;
+    void unionLiveIn(Symbol label, LiveSet& live) const;
+    void transfer(const Instruction& instr, LiveSet& live) const;
+
+    // 值 -> 下标，只含这个函数里出现的值
+    std::unordered_map<ValueKey, int> m_index;
+    std::vector<Operand> m_values;
+    const FunctionIR* m_func = nullptr;
+
+    std::vector<int> m_reachable_end;
+    std::vector<int> m_block_start;
+    std::vector<LiveSet> m_live_in;
+    std::vector<LiveSet> m_live_out;
+};
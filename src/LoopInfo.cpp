@@ -0,0 +1,166 @@
+#include "LoopInfo.hpp"
+#include "CFG.hpp"
+#include <algorithm>
+#include <map>
+
+void LoopInfo::compute(const FunctionIR& func) {
+    const int n = (int)func.blocks.size();
+    m_loops.clear();
+    m_innermost.assign(n, -1);
+    m_member.clear();
+
+    // 1. 回边，按 header 分组（同一个 header 的回边合成一个循环）
+    std::map<int, std::vector<int>> latches;
+    for (int b : func.cfg.rpo) {
+        for (int h : func.blocks[b].succs) {
+            if (dominates(func, h, b)) latches[h].push_back(b);
+        }
+    }
+
+    // 2. 循环体：从 latch 逆着边走，直到 header
+    for (auto& entry : latches) {
+        Loop loop;
+        loop.header = entry.first;
+        loop.latches = entry.second;
+        std::vector<bool> in_loop(n, false);
+        in_loop[loop.header] = true;
+        std::vector<int> work;
+        for (int latch : loop.latches) {
+            if (!in_loop[latch]) {
+                in_loop[latch] = true;
+                work.push_back(latch);
+            }
+        }
+        while (!work.empty()) {
+            int b = work.back();
+            work.pop_back();
+            for (int p : func.blocks[b].preds) {
+                if (!is_reachable(func, p) || in_loop[p]) continue;
+                in_loop[p] = true;
+                work.push_back(p);
+            }
+        }
+        for (int b = 0; b < n; ++b) {
+            if (!in_loop[b]) continue;
+            loop.blocks.push_back(b);
+            for (int s : func.blocks[b].succs) {
+                if (!in_loop[s] && std::find(loop.exits.begin(), loop.exits.end(), s) == loop.exits.end()) {
+                    loop.exits.push_back(s);
+                }
+            }
+        }
+
+        // 前置块：header 唯一的循环外前驱，并且它只流向 header
+        int outside = -1, num_outside = 0;
+        for (int p : func.blocks[loop.header].preds) {
+            if (!in_loop[p] && is_reachable(func, p)) {
+                outside = p;
+                ++num_outside;
+            }
+        }
+        if (num_outside == 1 && func.blocks[outside].succs.size() == 1) loop.preheader = outside;
+
+        m_loops.push_back(std::move(loop));
+        m_member.push_back(std::move(in_loop));
+    }
+
+    // 3. 内层在前，确定嵌套关系
+    std::vector<int> order(m_loops.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return m_loops[a].blocks.size() < m_loops[b].blocks.size();
+    });
+    std::vector<Loop> loops;
+    std::vector<std::vector<bool>> member;
+    for (int i : order) {
+        loops.push_back(std::move(m_loops[i]));
+        member.push_back(std::move(m_member[i]));
+    }
+    m_loops = std::move(loops);
+    m_member = std::move(member);
+
+    for (int l = 0; l < (int)m_loops.size(); ++l) {
+        for (int o = l + 1; o < (int)m_loops.size(); ++o) {
+            if (m_member[o][m_loops[l].header]) {
+                m_loops[l].parent = o;
+                break;
+            }
+        }
+    }
+    for (int l = (int)m_loops.size() - 1; l >= 0; --l) {
+        int p = m_loops[l].parent;
+        m_loops[l].depth = p < 0 ? 1 : m_loops[p].depth + 1;
+    }
+    for (int l = (int)m_loops.size() - 1; l >= 0; --l) {
+        for (int b : m_loops[l].blocks) m_innermost[b] = l; // 外层先写，内层覆盖
+    }
+}
+
+int insert_preheader(FunctionIR& func, const LoopInfo& loops, int l) {
+    const Loop& loop = loops.loop(l);
+    if (loop.preheader >= 0) return loop.preheader;
+
+    const int h = loop.header;
+    const Symbol header_label = func.blocks[h].label;
+    BasicBlock pre;
+    pre.label = new_block_label(func, "preheader");
+
+    std::vector<int> outside;
+    for (int p : func.blocks[h].preds) {
+        if (!loops.contains(l, p) && is_reachable(func, p)) outside.push_back(p);
+    }
+
+    // header 中的 PHI：循环外的实参合并到前置块
+    for (auto& instr : func.blocks[h].instructions) {
+        if (instr.opcode != Instruction::PHI) break;
+        std::vector<Instruction::PhiArg> inside, from_outside;
+        for (auto& arg : instr.phi_args) {
+            int p = find_block(func, arg.block);
+            if (p >= 0 && loops.contains(l, p)) inside.push_back(arg);
+            else if (p >= 0 && is_reachable(func, p)) from_outside.push_back(arg);
+        }
+        Operand incoming;
+        if (from_outside.size() == 1) {
+            incoming = from_outside[0].value;
+        }
+        else if (!from_outside.empty()) {
+            Instruction phi;
+            phi.opcode = Instruction::PHI;
+            phi.result = make_temp(func);
+            phi.phi_args = from_outside;
+            pre.instructions.push_back(phi);
+            incoming = phi.result;
+        }
+        inside.push_back({ pre.label, incoming });
+        instr.phi_args = std::move(inside);
+    }
+
+    // 循环外跳到 header 的改为跳到前置块
+    for (int p : outside) {
+        for (auto& instr : func.blocks[p].instructions) {
+            if (instr.opcode == Instruction::JUMP && instr.arg1.name == header_label) instr.arg1.name = pre.label;
+            if ((instr.opcode == Instruction::JUMP_IF_ZERO || instr.opcode == Instruction::JUMP_IF_NZERO) &&
+                instr.arg2.name == header_label) instr.arg2.name = pre.label;
+        }
+    }
+
+    // 布局：header 的前一块是循环外的前驱时，把前置块放在两者之间，落入 header；
+    // 否则放到函数末尾，显式跳到 header
+    const bool falls_in = h > 0 && !loops.contains(l, h - 1) &&
+        std::find(outside.begin(), outside.end(), h - 1) != outside.end();
+    int pos;
+    if (falls_in) {
+        pos = h;
+    }
+    else {
+        Instruction jump;
+        jump.opcode = Instruction::JUMP;
+        jump.arg1.kind = Operand::LABEL;
+        jump.arg1.name = header_label;
+        pre.instructions.push_back(jump);
+        pos = (int)func.blocks.size();
+    }
+    func.blocks.insert(func.blocks.begin() + pos, std::move(pre));
+    build_cfg(func);
+    return pos;
+}
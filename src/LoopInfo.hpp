@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ir.hpp"
+#include <vector>
+
+// 自然循环：由一条或多条回边 latch -> header（header 支配 latch）确定，
+// 循环体是不经过 header 能到达某个 latch 的所有块加上 header。
+struct Loop {
+    int header = -1;
+    std::vector<int> blocks;   // 循环中的块（含 header），按块 id 排序
+    std::vector<int> latches;  // 回边的源
+    std::vector<int> exits;    // 循环外、但是循环内某块的后继的块
+    int parent = -1;           // 直接外层循环的下标，-1 表示最外层
+    int depth = 1;             // 嵌套深度，最外层为 1
+    int preheader = -1;        // 唯一的循环外前驱且只有 header 一个后继时为其 id，否则 -1
+};
+
+// 函数的循环嵌套信息（需要先 build_cfg）。
+// 循环按块数从少到多排列，所以内层循环总在外层循环之前。
+class LoopInfo {
+public:
+    void compute(const FunctionIR& func);
+
+    const std::vector<Loop>& loops() const { return m_loops; }
+    const Loop& loop(int l) const { return m_loops[l]; }
+
+    // 包含块 b 的最内层循环，-1 表示不在任何循环中
+    int loopOf(int b) const { return m_innermost[b]; }
+    // 块 b 的循环嵌套深度，不在循环中为 0
+    int depth(int b) const { return m_innermost[b] < 0 ? 0 : m_loops[m_innermost[b]].depth; }
+    bool contains(int l, int b) const { return m_member[l][b]; }
+
+private:
+    std::vector<Loop> m_loops;
+    std::vector<int> m_innermost;
+    std::vector<std::vector<bool>> m_member;
+};
+
+// 为循环 l 建立前置块（preheader）并重建控制流图：循环外进入 header 的边都改为先经过它，
+// header 中 PHI 来自循环外的实参随之移到前置块。已经有前置块时不做任何事。
+// 返回前置块的 id；控制流图改变后之前算出的 LoopInfo 失效。
+int insert_preheader(FunctionIR& func, const LoopInfo& loops, int l);
@@ -0,0 +1,89 @@
+#include "LoopRotation.hpp"
+#include "LoopInfo.hpp"
+#include "CFG.hpp"
+#include "Liveness.hpp"
+#include <unordered_map>
+
+namespace {
+
+// header 里条件跳转之前最多几条指令；复制更多就不如回边上的一次跳转划算
+const int kMaxHeaderSize = 4;
+
+bool is_pure(const Instruction& instr) {
+    switch (instr.opcode) {
+    case Instruction::ADD: case Instruction::SUB: case Instruction::MUL: case Instruction::DIV: case Instruction::MOD:
+    case Instruction::NOT: case Instruction::EQ: case Instruction::NEQ: case Instruction::LT: case Instruction::GT:
+    case Instruction::LE: case Instruction::GE: case Instruction::ASSIGN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+bool LoopRotationPass::runOnFunction(FunctionIR& func) {
+    if (func.in_ssa) return false;
+    LoopInfo loops;
+    loops.compute(func);
+    bool changed = false;
+
+    std::unordered_map<ValueKey, int> use_count;
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            for_each_use(instr, [&](const Operand& op) { use_count[Liveness::keyOf(op)]++; });
+        }
+    }
+
+    for (int l = 0; l < (int)loops.loops().size(); ++l) {
+        const Loop& loop = loops.loop(l);
+        const int h = loop.header;
+        const auto& header = func.blocks[h].instructions;
+        if (header.empty() || (int)header.size() - 1 > kMaxHeaderSize || h + 1 >= (int)func.blocks.size()) continue;
+        const Instruction& br = header.back();
+        if (br.opcode != Instruction::JUMP_IF_ZERO && br.opcode != Instruction::JUMP_IF_NZERO) continue;
+        bool pure = true;
+        for (size_t i = 0; i + 1 < header.size(); ++i) pure = pure && is_pure(header[i]);
+        if (!pure) continue;
+
+        // 一个后继在循环内，一个在循环外
+        const int taken = find_block(func, br.arg2.name);
+        const Symbol fall_label = func.blocks[h + 1].label;
+        if (taken < 0 || fall_label.empty() || loops.contains(l, taken) == loops.contains(l, h + 1)) continue;
+
+        // 只在 header 内部使用的临时变量，复制时换名
+        std::unordered_map<ValueKey, int> local_uses;
+        for (const auto& instr : header) {
+            for_each_use(instr, [&](const Operand& op) { local_uses[Liveness::keyOf(op)]++; });
+        }
+
+        for (int latch : loop.latches) {
+            auto& instrs = func.blocks[latch].instructions;
+            if (latch == h || instrs.empty() || instrs.back().opcode != Instruction::JUMP ||
+                instrs.back().arg1.name != func.blocks[h].label) continue;
+            Instruction fall;
+            fall.opcode = Instruction::JUMP;
+            fall.arg1.kind = Operand::LABEL;
+            fall.arg1.name = fall_label;
+            instrs.pop_back();
+            std::unordered_map<ValueKey, Operand> renamed;
+            for (Instruction copy : header) {
+                for_each_use(copy, [&](Operand& op) {
+                    auto it = renamed.find(Liveness::keyOf(op));
+                    if (it != renamed.end()) op = it->second;
+                });
+                if (Operand* def = instr_def(copy)) {
+                    const ValueKey key = Liveness::keyOf(*def);
+                    if (def->kind == Operand::TEMP && use_count[key] == local_uses[key]) {
+                        *def = make_temp(func);
+                        renamed[key] = *def;
+                    }
+                }
+                instrs.push_back(copy);
+            }
+            instrs.push_back(fall);
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class LoopRotationPass
+ * @brief 循环旋转：把 while 循环的条件测试复制到循环底部
+ *
+ * IRGenerator 生成的 while 循环每次迭代都要先跳回 header 测试条件，再跳进循环体：
+ * 回边上的 JUMP 加上 header 的条件跳转。对 header 只有几条纯运算加一条条件跳转、
+ * 一个后继在循环内一个在循环外的循环，把回边块末尾的 `JUMP header` 换成 header 的一份复制
+ * （条件跳转之后再补一条跳到 header 落入块的 JUMP），条件就在循环底部测试；
+ * 原来的 header 只在进入循环时执行一次，相当于 do-while 前面的守卫。
+ * 在 SSA 消去之后运行。复制出来的定值沿用原来的名字，只有用在 header 内部的临时变量
+ * （典型的是条件）换成新的临时变量，好让指令选择仍然能把比较和分支合并。
+ */
+class LoopRotationPass : public FunctionPass {
+public:
+    const char* name() const override { return "rotate"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
@@ -0,0 +1,438 @@
+#include "LoopStrengthReduction.hpp"
+#include "InductionVariables.hpp"
+#include "LoopInfo.hpp"
+#include "CFG.hpp"
+#include "Liveness.hpp"
+#include "SCCP.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+int wrap_mul(int a, int b) {
+    return (int)((unsigned)a * (unsigned)b);
+}
+
+bool is_compare(Instruction::OpCode op) {
+    return op == Instruction::EQ || op == Instruction::NEQ || op == Instruction::LT ||
+        op == Instruction::GT || op == Instruction::LE || op == Instruction::GE;
+}
+
+// 两边同乘一个负数后比较的方向反过来
+Instruction::OpCode mirror_compare(Instruction::OpCode op) {
+    switch (op) {
+    case Instruction::LT: return Instruction::GT;
+    case Instruction::GT: return Instruction::LT;
+    case Instruction::LE: return Instruction::GE;
+    case Instruction::GE: return Instruction::LE;
+    default: return op;
+    }
+}
+
+// !(a OP b)  <=>  a negate(OP) b
+Instruction::OpCode negate_compare(Instruction::OpCode op) {
+    switch (op) {
+    case Instruction::LT: return Instruction::GE;
+    case Instruction::GE: return Instruction::LT;
+    case Instruction::GT: return Instruction::LE;
+    case Instruction::LE: return Instruction::GT;
+    case Instruction::EQ: return Instruction::NEQ;
+    default: return Instruction::EQ;
+    }
+}
+
+Operand make_const(int value) {
+    Operand op;
+    op.kind = Operand::CONST;
+    op.value = value;
+    return op;
+}
+
+Instruction make_binary(Instruction::OpCode opcode, const Operand& result, const Operand& a, const Operand& b) {
+    Instruction instr;
+    instr.opcode = opcode;
+    instr.result = result;
+    instr.arg1 = a;
+    instr.arg2 = b;
+    return instr;
+}
+
+// 乘以常量 c 大致要几条指令（代码生成器会把 ±2^k 变成一次移位）
+bool is_power_of_two_multiple(int c) {
+    unsigned a = c < 0 ? 0u - (unsigned)c : (unsigned)c;
+    return a != 0 && (a & (a - 1)) == 0;
+}
+
+// 删除一条运算能省下的代价
+int op_cost(const Instruction& instr) {
+    switch (instr.opcode) {
+    case Instruction::ADD: case Instruction::SUB:
+        return 1;
+    case Instruction::MUL: {
+        const Operand& k = instr.arg1.kind == Operand::CONST ? instr.arg1 : instr.arg2;
+        if (k.kind != Operand::CONST) return 3; // 真正的乘法
+        return is_power_of_two_multiple(k.value) ? 1 : 2;
+    }
+    default:
+        return 0;
+    }
+}
+
+// 在前置块里按 biv = subst 重新计算循环中的归纳变量表达式，新指令追加到 out
+class Materializer {
+public:
+    Materializer(FunctionIR& func, const InductionVariables& ivs, std::vector<Instruction>& out)
+        : m_func(func), m_ivs(ivs), m_out(out) {}
+
+    Operand get(const Operand& op, const Operand& biv_phi, const Operand& subst) {
+        m_memo.clear();
+        return rec(op, biv_phi, subst);
+    }
+
+private:
+    Operand rec(const Operand& op, const Operand& biv_phi, const Operand& subst) {
+        if (same_value(op, biv_phi)) return subst;
+        if (m_ivs.isInvariant(op)) return op;
+        const ValueKey key = Liveness::keyOf(op);
+        auto it = m_memo.find(key);
+        if (it != m_memo.end()) return it->second;
+
+        const DerivedIV* d = m_ivs.find(op);
+        Instruction copy = m_func.blocks[d->def.block].instructions[d->def.index];
+        copy.arg1 = rec(copy.arg1, biv_phi, subst);
+        if (copy.opcode == Instruction::ASSIGN) return m_memo[key] = copy.arg1;
+        copy.arg2 = rec(copy.arg2, biv_phi, subst);
+        // 初值和边界常常是常量，能折叠就不生成指令
+        Operand folded = simplify(copy);
+        if (folded.kind != Operand::NONE) return m_memo[key] = folded;
+        copy.result = make_temp(m_func);
+        m_out.push_back(copy);
+        return m_memo[key] = copy.result;
+    }
+
+    // 常量折叠以及 x + 0、x - 0、x * 1；不能化简时返回 NONE
+    static Operand simplify(const Instruction& instr) {
+        const Operand& a = instr.arg1;
+        const Operand& b = instr.arg2;
+        int value;
+        if (a.kind == Operand::CONST && b.kind == Operand::CONST && fold_binary(instr.opcode, a.value, b.value, value)) {
+            return make_const(value);
+        }
+        const int identity = instr.opcode == Instruction::MUL ? 1 : 0;
+        if (b.kind == Operand::CONST && b.value == identity) return a;
+        if (instr.opcode != Instruction::SUB && a.kind == Operand::CONST && a.value == identity) return b;
+        return Operand();
+    }
+
+    FunctionIR& m_func;
+    const InductionVariables& m_ivs;
+    std::vector<Instruction>& m_out;
+    std::unordered_map<ValueKey, Operand> m_memo;
+};
+
+// 基本归纳变量 biv 在循环里取到的值的范围 [lo, hi]。要求 header 用 `c = phi OP 常量; IF c JUMP` 决定
+// 是否离开循环、初值是常量，并且 phi 在离开之前不会回绕（见 trip_count）；否则返回 false。
+// 循环里其他地方的退出只会让迭代更少，不影响这个范围
+bool biv_range(const FunctionIR& func, const LoopInfo& loops, int l, const BasicIV& biv, long long& lo, long long& hi) {
+    if (biv.init.kind != Operand::CONST) return false;
+    const int h = loops.loop(l).header;
+    const auto& instrs = func.blocks[h].instructions;
+    // 条件跳转之后可以再跟一条无条件跳转，否则落到下一个块
+    int br = (int)instrs.size() - 1;
+    if (br >= 0 && instrs[br].opcode == Instruction::JUMP) --br;
+    if (br < 0) return false;
+    const Instruction& jump = instrs[br];
+    if (jump.opcode != Instruction::JUMP_IF_ZERO && jump.opcode != Instruction::JUMP_IF_NZERO) return false;
+    const Instruction* cmp = nullptr;
+    for (int i = br - 1; i >= 0 && !cmp; --i) {
+        if (same_value(instrs[i].result, jump.arg1)) cmp = &instrs[i];
+    }
+    if (!cmp || !is_compare(cmp->opcode)) return false;
+
+    Instruction::OpCode op = cmp->opcode;
+    int bound;
+    if (same_value(cmp->arg1, biv.phi) && cmp->arg2.kind == Operand::CONST) {
+        bound = cmp->arg2.value;
+    }
+    else if (same_value(cmp->arg2, biv.phi) && cmp->arg1.kind == Operand::CONST) {
+        bound = cmp->arg1.value;
+        op = mirror_compare(op);
+    }
+    else {
+        return false;
+    }
+
+    const int taken = find_block(func, jump.arg2.name);
+    const int other = br + 1 < (int)instrs.size() ? find_block(func, instrs[br + 1].arg1.name) : h + 1;
+    if (taken < 0 || other < 0 || other >= (int)func.blocks.size()) return false;
+    if (loops.contains(l, taken) == loops.contains(l, other)) return false;
+    const bool continue_if_true = (jump.opcode == Instruction::JUMP_IF_NZERO) == loops.contains(l, taken);
+    if (!continue_if_true) op = negate_compare(op);
+
+    long long n;
+    if (!trip_count(op, biv.init.value, bound, biv.step, n)) return false;
+    const long long first = biv.init.value;
+    const long long last = first + n * biv.step; // header 最后一次看到的值
+    lo = std::min(first, last);
+    hi = std::max(first, last);
+    return true;
+}
+
+bool fits_int32(long long v) {
+    return v >= INT32_MIN && v <= INT32_MAX;
+}
+
+struct Reduction {
+    const DerivedIV* iv;
+    Operand phi;   // 新的 PHI：本次迭代 iv 的值
+    Operand init;  // 前置块里算出的初值
+    Operand next;  // 回边上的值 phi + inc
+    Operand inc;
+};
+
+struct TestReplacement {
+    InstrRef at;
+    Instruction original;
+    Instruction replaced;
+    int biv;
+};
+
+// 削弱一个循环；返回是否修改了 IR
+bool reduce_loop(FunctionIR& func, const LoopInfo& loops, int l) {
+    InductionVariables ivs;
+    ivs.compute(func, loops, l);
+    if (ivs.basics().empty()) return false;
+    const Loop& loop = loops.loop(l);
+
+    std::unordered_map<ValueKey, int> use_count;
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            for_each_use(instr, [&](const Operand& op) { use_count[Liveness::keyOf(op)]++; });
+        }
+    }
+
+    // 删掉 d 的定值能省下的代价：它本身加上只为它计算的归纳变量运算
+    std::function<int(const DerivedIV&)> removable = [&](const DerivedIV& d) {
+        const Instruction& instr = func.blocks[d.def.block].instructions[d.def.index];
+        if (instr.opcode == Instruction::PHI) return 0;
+        int cost = op_cost(instr);
+        for_each_use(instr, [&](const Operand& op) {
+            const DerivedIV* src = ivs.find(op);
+            if (src && use_count[Liveness::keyOf(op)] == 1) cost += removable(*src);
+        });
+        return cost;
+    };
+
+    // 1. 选出值得削弱的乘法：省下的代价要超过回边上新增的一条加法
+    std::vector<const DerivedIV*> chosen;
+    for (const auto& d : ivs.derived()) {
+        const Instruction& instr = func.blocks[d.def.block].instructions[d.def.index];
+        if (instr.opcode != Instruction::MUL) continue;
+        if (ivs.basics()[d.biv].step == 0 || d.scale == 0) continue;
+        if (removable(d) >= 2) chosen.push_back(&d);
+    }
+    if (chosen.empty()) return false;
+
+    std::vector<Instruction> hoisted; // 放到前置块末尾
+    Materializer mat(func, ivs, hoisted);
+    std::vector<Reduction> reductions;
+    for (const DerivedIV* d : chosen) {
+        const BasicIV& biv = ivs.basics()[d->biv];
+        Reduction r;
+        r.iv = d;
+        r.init = mat.get(d->value, biv.phi, biv.init);
+        const int inc = wrap_mul(d->scale, biv.step);
+        if (d->factor.kind == Operand::NONE) {
+            r.inc = make_const(inc);
+        }
+        else if (inc == 1) {
+            r.inc = d->factor;
+        }
+        else {
+            r.inc = make_temp(func);
+            hoisted.push_back(make_binary(Instruction::MUL, r.inc, d->factor, make_const(inc)));
+        }
+        r.phi = make_temp(func);
+        r.next = make_temp(func);
+        reductions.push_back(r);
+    }
+
+    // 2. 线性函数测试替换：i OP bound 改成 scale * i + offset OP scale * bound + offset，与某个乘数为常量的
+    // 新 PHI 比较。新 PHI 按 32 位回绕计算，所以只有初值、边界和 offset 都是常量，并且 i 取到的每个值和
+    // bound 代进去都不越界时两边才等价；否则保留原来的比较
+    std::vector<TestReplacement> tests;
+    for (int b : loop.blocks) {
+        const auto& instrs = func.blocks[b].instructions;
+        for (int i = 0; i < (int)instrs.size(); ++i) {
+            const Instruction& cmp = instrs[i];
+            if (!is_compare(cmp.opcode)) continue;
+            for (int k = 0; k < (int)ivs.basics().size(); ++k) {
+                const BasicIV& biv = ivs.basics()[k];
+                const bool lhs = same_value(cmp.arg1, biv.phi) && ivs.isInvariant(cmp.arg2);
+                const bool rhs = same_value(cmp.arg2, biv.phi) && ivs.isInvariant(cmp.arg1);
+                if (!lhs && !rhs) continue;
+                const Reduction* use = nullptr;
+                for (const auto& r : reductions) {
+                    if (r.iv->biv == k && r.iv->factor.kind == Operand::NONE) {
+                        use = &r;
+                        break;
+                    }
+                }
+                if (!use) break;
+                const Operand& bound = lhs ? cmp.arg2 : cmp.arg1;
+                long long lo, hi;
+                if (bound.kind != Operand::CONST || !biv_range(func, loops, l, biv, lo, hi)) break;
+                // 代入常量后整条表达式都能折叠，不会生成指令
+                const size_t mark = hoisted.size();
+                const Operand offset = mat.get(use->iv->value, biv.phi, make_const(0));
+                if (offset.kind != Operand::CONST) {
+                    hoisted.erase(hoisted.begin() + mark, hoisted.end());
+                    break;
+                }
+                const long long scale = use->iv->scale;
+                const long long new_bound = scale * bound.value + offset.value;
+                if (!fits_int32(scale * lo + offset.value) || !fits_int32(scale * hi + offset.value) || !fits_int32(new_bound)) break;
+                TestReplacement t;
+                t.at = { b, i };
+                t.original = cmp;
+                t.replaced = cmp;
+                t.biv = k;
+                (lhs ? t.replaced.arg1 : t.replaced.arg2) = use->phi;
+                (lhs ? t.replaced.arg2 : t.replaced.arg1) = make_const((int)new_bound);
+                if (use->iv->scale < 0) t.replaced.opcode = mirror_compare(cmp.opcode);
+                tests.push_back(t);
+                break;
+            }
+        }
+    }
+
+    // 3. 改写：被削弱的定值换成复制，比较换成新的形式
+    for (const auto& r : reductions) {
+        Instruction& def = func.blocks[r.iv->def.block].instructions[r.iv->def.index];
+        Instruction copy;
+        copy.opcode = Instruction::ASSIGN;
+        copy.result = def.result;
+        copy.arg1 = r.phi;
+        def = copy;
+    }
+    for (const auto& t : tests) func.blocks[t.at.block].instructions[t.at.index] = t.replaced;
+
+    // 基本归纳变量在改写后仍被循环外或非归纳变量的运算用到时，测试替换没有意义，撤销
+    std::set<int> tested;
+    for (const auto& t : tests) tested.insert(t.biv);
+    for (int k : tested) {
+        std::unordered_set<ValueKey> family; // biv k 的所有归纳变量
+        for (const auto& d : ivs.derived()) {
+            if (d.biv == k) family.insert(Liveness::keyOf(d.value));
+        }
+        std::unordered_map<ValueKey, const Instruction*> def_of;
+        std::vector<ValueKey> work;
+        std::unordered_set<ValueKey> live;
+        for (const auto& bb : func.blocks) {
+            for (const auto& instr : bb.instructions) {
+                const Operand* def = instr_def(instr);
+                if (def && family.count(Liveness::keyOf(*def))) {
+                    def_of[Liveness::keyOf(*def)] = &instr;
+                    continue;
+                }
+                for_each_use(instr, [&](const Operand& op) {
+                    ValueKey key = Liveness::keyOf(op);
+                    if (family.count(key) && live.insert(key).second) work.push_back(key);
+                });
+            }
+        }
+        while (!work.empty()) {
+            ValueKey key = work.back();
+            work.pop_back();
+            auto it = def_of.find(key);
+            if (it == def_of.end()) continue;
+            for_each_use(*it->second, [&](const Operand& op) {
+                ValueKey k2 = Liveness::keyOf(op);
+                if (family.count(k2) && live.insert(k2).second) work.push_back(k2);
+            });
+        }
+        if (!live.count(Liveness::keyOf(ivs.basics()[k].phi))) continue;
+        for (const auto& t : tests) {
+            if (t.biv == k) func.blocks[t.at.block].instructions[t.at.index] = t.original;
+        }
+    }
+
+    // 4. 回边上的增量、header 中的新 PHI、前置块里的初值
+    const Symbol latch_label = func.blocks[ivs.latch()].label;
+    const Symbol pre_label = func.blocks[loop.preheader].label;
+    auto& latch = func.blocks[ivs.latch()].instructions;
+    auto latch_pos = (!latch.empty() && jump_target(latch.back())) ? latch.end() - 1 : latch.end();
+    std::vector<Instruction> increments;
+    for (const auto& r : reductions) increments.push_back(make_binary(Instruction::ADD, r.next, r.phi, r.inc));
+    latch.insert(latch_pos, increments.begin(), increments.end());
+
+    auto& header = func.blocks[loop.header].instructions;
+    auto phi_pos = header.begin();
+    while (phi_pos != header.end() && phi_pos->opcode == Instruction::PHI) ++phi_pos;
+    std::vector<Instruction> phis;
+    for (const auto& r : reductions) {
+        Instruction phi;
+        phi.opcode = Instruction::PHI;
+        phi.result = r.phi;
+        phi.phi_args.push_back({ pre_label, r.init });
+        phi.phi_args.push_back({ latch_label, r.next });
+        phis.push_back(phi);
+    }
+    header.insert(phi_pos, phis.begin(), phis.end());
+
+    auto& pre = func.blocks[loop.preheader].instructions;
+    auto pre_pos = (!pre.empty() && jump_target(pre.back())) ? pre.end() - 1 : pre.end();
+    pre.insert(pre_pos, hoisted.begin(), hoisted.end());
+    return true;
+}
+
+int loop_with_header(const FunctionIR& func, const LoopInfo& loops, Symbol header) {
+    for (int l = 0; l < (int)loops.loops().size(); ++l) {
+        if (func.blocks[loops.loop(l).header].label == header) return l;
+    }
+    return -1;
+}
+
+} // namespace
+
+bool LoopStrengthReductionPass::runOnFunction(FunctionIR& func) {
+    if (!func.in_ssa) return false;
+    bool changed = false;
+    std::set<Symbol> done; // 已处理循环的 header 标签（插入前置块会改变块 id）
+    LoopInfo loops;
+
+    for (;;) {
+        loops.compute(func);
+        int l = -1;
+        for (int i = 0; i < (int)loops.loops().size(); ++i) {
+            if (!done.count(func.blocks[loops.loop(i).header].label)) {
+                l = i;
+                break;
+            }
+        }
+        if (l < 0) break;
+        const Symbol header = func.blocks[loops.loop(l).header].label;
+        done.insert(header);
+
+        // 只有一条回边的循环才有归纳变量；需要前置块来放初值
+        if (loops.loop(l).latches.size() != 1) continue;
+        if (loops.loop(l).preheader < 0) {
+            InductionVariables ivs;
+            ivs.compute(func, loops, l);
+            if (ivs.basics().empty()) continue;
+            insert_preheader(func, loops, l);
+            loops.compute(func);
+            l = loop_with_header(func, loops, header);
+            changed = true;
+        }
+        if (reduce_loop(func, loops, l)) {
+            build_cfg(func);
+            changed = true;
+        }
+    }
+    return changed;
+}
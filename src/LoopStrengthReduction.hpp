@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class LoopStrengthReductionPass
+ * @brief 循环强度削弱与线性函数测试替换
+ *
+ * 在 SSA 形式上按自然循环从内到外处理（归纳变量的识别见 InductionVariables）：
+ *   - 强度削弱：派生归纳变量 d = scale * factor * i + offset 如果由乘法得到，
+ *     并且删掉它之后能省下的运算（乘法本身和只为它计算的加减、乘法）值得一个新的 PHI，
+ *     就在前置块里算出 d 的初值，在 header 放一个新的 PHI p，回边上 p += scale * factor * step，
+ *     原来的定值换成 d = p。原来的乘法链由 DCE 删除。
+ *   - 线性函数测试替换：循环里 `i OP bound`（bound 为循环不变量）改写成与某个已削弱的、
+ *     乘数为常量的派生归纳变量比较：`p OP' d(bound)`，d(bound) 在前置块里计算。
+ *     改写后基本归纳变量 i 如果除了自身的更新之外不再被使用，就整个死掉；否则撤销改写。
+ *     这一步和常见的做法一样假设有符号运算不溢出（源语言中溢出是未定义行为）。
+ */
+class LoopStrengthReductionPass : public FunctionPass {
+public:
+    const char* name() const override { return "lsr"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
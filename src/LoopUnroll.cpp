@@ -0,0 +1,382 @@
+#include "LoopUnroll.hpp"
+#include "InductionVariables.hpp"
+#include "LoopInfo.hpp"
+#include "CFG.hpp"
+#include "Liveness.hpp"
+#include <set>
+#include <unordered_map>
+
+namespace {
+
+const int kFullUnrollMaxSize = 64;    // 完全展开后循环体指令总数的上限
+const int kPartialUnrollMaxSize = 64; // 部分展开后一轮循环体指令数的上限
+const int kUnrollFactors[] = { 4, 2 };
+
+bool is_compare(Instruction::OpCode op) {
+    return op == Instruction::EQ || op == Instruction::NEQ || op == Instruction::LT ||
+        op == Instruction::GT || op == Instruction::LE || op == Instruction::GE;
+}
+
+// bound OP i  <=>  i mirror(OP) bound
+Instruction::OpCode mirror_compare(Instruction::OpCode op) {
+    switch (op) {
+    case Instruction::LT: return Instruction::GT;
+    case Instruction::GT: return Instruction::LT;
+    case Instruction::LE: return Instruction::GE;
+    case Instruction::GE: return Instruction::LE;
+    default: return op;
+    }
+}
+
+// !(a OP b)  <=>  a negate(OP) b
+Instruction::OpCode negate_compare(Instruction::OpCode op) {
+    switch (op) {
+    case Instruction::LT: return Instruction::GE;
+    case Instruction::GE: return Instruction::LT;
+    case Instruction::GT: return Instruction::LE;
+    case Instruction::LE: return Instruction::GT;
+    case Instruction::EQ: return Instruction::NEQ;
+    default: return Instruction::EQ;
+    }
+}
+
+// header 中的 PHI：从前置块和回边进入时的值
+struct HeaderPhi {
+    Operand result;
+    Operand from_preheader;
+    Operand from_latch;
+};
+
+struct CountedLoop {
+    int header = -1;
+    int latch = -1;
+    int preheader = -1;
+    std::vector<int> body;       // 除 header 外的循环块，按布局顺序
+    Symbol body_entry;           // header 在循环内的后继
+    Symbol exit;                 // header 在循环外的后继
+    std::vector<HeaderPhi> phis;
+    long long trip = 0;
+    int size = 0;                // 循环体的指令数
+};
+
+bool analyze(const FunctionIR& func, const LoopInfo& loops, int l, CountedLoop& c) {
+    const Loop& loop = loops.loop(l);
+    for (const auto& other : loops.loops()) {
+        if (other.parent == l) return false; // 只展开最内层循环
+    }
+    if (loop.latches.size() != 1 || loop.preheader < 0) return false;
+    c.header = loop.header;
+    c.latch = loop.latches[0];
+    c.preheader = loop.preheader;
+
+    // header：PHI……，cond = i OP bound，IF cond JUMP
+    const auto& instrs = func.blocks[c.header].instructions;
+    int i = 0;
+    while (i < (int)instrs.size() && instrs[i].opcode == Instruction::PHI) ++i;
+    if ((int)instrs.size() != i + 2 || c.header + 1 >= (int)func.blocks.size()) return false;
+    const Instruction& cmp = instrs[i];
+    const Instruction& br = instrs[i + 1];
+    if (!is_compare(cmp.opcode) || !same_value(br.arg1, cmp.result)) return false;
+    if (br.opcode != Instruction::JUMP_IF_ZERO && br.opcode != Instruction::JUMP_IF_NZERO) return false;
+    int uses = 0;
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            for_each_use(instr, [&](const Operand& op) { if (same_value(op, cmp.result)) ++uses; });
+        }
+    }
+    if (uses != 1) return false;
+
+    const int taken = find_block(func, br.arg2.name);
+    const int fall = c.header + 1;
+    if (taken < 0 || loops.contains(l, taken) == loops.contains(l, fall)) return false;
+    const bool taken_stays = loops.contains(l, taken);
+    c.body_entry = func.blocks[taken_stays ? taken : fall].label;
+    c.exit = func.blocks[taken_stays ? fall : taken].label;
+    if (c.exit.empty()) return false;
+    const bool continue_if_true = (br.opcode == Instruction::JUMP_IF_NZERO) == taken_stays;
+
+    // 只能从 header 退出
+    c.body.clear();
+    c.size = 0;
+    for (int b : loop.blocks) {
+        if (b == c.header) continue;
+        if (func.blocks[b].label.empty()) return false;
+        for (int s : func.blocks[b].succs) {
+            if (!loops.contains(l, s)) return false;
+        }
+        c.body.push_back(b);
+        c.size += (int)func.blocks[b].instructions.size();
+    }
+
+    // 迭代次数：比较的一边是常量初值、常量步长的基本归纳变量，另一边是常量
+    InductionVariables ivs;
+    ivs.compute(func, loops, l);
+    const BasicIV* iv = nullptr;
+    Instruction::OpCode op = cmp.opcode;
+    int bound = 0;
+    for (const auto& biv : ivs.basics()) {
+        if (biv.init.kind != Operand::CONST) continue;
+        if (same_value(cmp.arg1, biv.phi) && cmp.arg2.kind == Operand::CONST) {
+            iv = &biv;
+            bound = cmp.arg2.value;
+        }
+        else if (same_value(cmp.arg2, biv.phi) && cmp.arg1.kind == Operand::CONST) {
+            iv = &biv;
+            bound = cmp.arg1.value;
+            op = mirror_compare(op);
+        }
+        if (iv) break;
+    }
+    if (!iv) return false;
+    if (!continue_if_true) op = negate_compare(op);
+    if (!trip_count(op, iv->init.value, bound, iv->step, c.trip)) return false;
+
+    const Symbol pre_label = func.blocks[c.preheader].label;
+    c.phis.clear();
+    for (int k = 0; k < i; ++k) {
+        HeaderPhi phi;
+        phi.result = instrs[k].result;
+        for (const auto& arg : instrs[k].phi_args) {
+            (arg.block == pre_label ? phi.from_preheader : phi.from_latch) = arg.value;
+        }
+        c.phis.push_back(phi);
+    }
+    return true;
+}
+
+using ValueMap = std::unordered_map<ValueKey, Operand>;
+
+Operand lookup(const ValueMap& values, const Operand& op) {
+    if (!is_value(op)) return op;
+    auto it = values.find(Liveness::keyOf(op));
+    return it == values.end() ? op : it->second;
+}
+
+// 一份复制的块标签：原标签 -> 新标签
+std::unordered_map<Symbol, Symbol> new_labels(FunctionIR& func, const CountedLoop& c) {
+    std::unordered_map<Symbol, Symbol> labels;
+    for (int b : c.body) labels[func.blocks[b].label] = new_block_label(func, "unroll");
+    return labels;
+}
+
+// 复制一份循环体。values 预先放好 header 中每个 PHI 在这份里的值，复制时再加入循环体中
+// 每个定值的新名字；回到 header 的边改为跳到 next。返回按布局排列的新块。
+std::vector<BasicBlock> clone_body(FunctionIR& func, const CountedLoop& c,
+    const std::unordered_map<Symbol, Symbol>& labels, ValueMap& values, Symbol next) {
+    const Symbol header_label = func.blocks[c.header].label;
+    auto map_label = [&](Symbol label) {
+        if (label == header_label) return next;
+        auto it = labels.find(label);
+        return it == labels.end() ? label : it->second;
+    };
+
+    for (int b : c.body) {
+        for (const auto& instr : func.blocks[b].instructions) {
+            if (const Operand* def = instr_def(instr)) values[Liveness::keyOf(*def)] = make_temp(func);
+        }
+    }
+
+    std::vector<BasicBlock> blocks;
+    for (size_t j = 0; j < c.body.size(); ++j) {
+        const BasicBlock& src = func.blocks[c.body[j]];
+        BasicBlock bb;
+        bb.label = map_label(src.label);
+        for (const auto& instr : src.instructions) {
+            Instruction copy = instr;
+            for_each_use(copy, [&](Operand& op) { op = lookup(values, op); });
+            if (Operand* def = instr_def(copy)) *def = lookup(values, *def);
+            for (auto& arg : copy.phi_args) arg.block = map_label(arg.block);
+            if (copy.opcode == Instruction::JUMP) copy.arg1.name = map_label(copy.arg1.name);
+            if (copy.opcode == Instruction::JUMP_IF_ZERO || copy.opcode == Instruction::JUMP_IF_NZERO) {
+                copy.arg2.name = map_label(copy.arg2.name);
+            }
+            bb.instructions.push_back(std::move(copy));
+        }
+        // 原来落入下一块的，新位置上的下一块不一定是它的复制，需要时补一条 JUMP
+        const bool falls = bb.instructions.empty() || (bb.instructions.back().opcode != Instruction::JUMP &&
+            bb.instructions.back().opcode != Instruction::RET);
+        if (falls && c.body[j] + 1 < (int)func.blocks.size()) {
+            const Symbol target = map_label(func.blocks[c.body[j] + 1].label);
+            const bool adjacent = j + 1 < c.body.size() && c.body[j + 1] == c.body[j] + 1;
+            if (!adjacent) {
+                Instruction jump;
+                jump.opcode = Instruction::JUMP;
+                jump.arg1.kind = Operand::LABEL;
+                jump.arg1.name = target;
+                bb.instructions.push_back(jump);
+            }
+        }
+        blocks.push_back(std::move(bb));
+    }
+    return blocks;
+}
+
+// 块 b 中跳到 from 的边改为跳到 to；原来落入 from 的补一条显式的 JUMP
+void retarget(FunctionIR& func, int b, Symbol from, Symbol to) {
+    auto& instrs = func.blocks[b].instructions;
+    for (auto& instr : instrs) {
+        if (instr.opcode == Instruction::JUMP && instr.arg1.name == from) instr.arg1.name = to;
+        if ((instr.opcode == Instruction::JUMP_IF_ZERO || instr.opcode == Instruction::JUMP_IF_NZERO) &&
+            instr.arg2.name == from) instr.arg2.name = to;
+    }
+    const bool falls = instrs.empty() || (instrs.back().opcode != Instruction::JUMP && instrs.back().opcode != Instruction::RET);
+    if (falls && b + 1 < (int)func.blocks.size() && func.blocks[b + 1].label == from) {
+        Instruction jump;
+        jump.opcode = Instruction::JUMP;
+        jump.arg1.kind = Operand::LABEL;
+        jump.arg1.name = to;
+        instrs.push_back(jump);
+    }
+}
+
+// 剥离 count 次迭代（不带测试），第一份的 PHI 取 start 中的值，最后一份跳到 after。
+// 返回新块；start 更新为剥离之后 header 中 PHI 应取的值，entry 为第一份的入口（count 为 0 时是 after），
+// last_latch 为最后一份回边的标签。
+std::vector<BasicBlock> peel(FunctionIR& func, const CountedLoop& c, long long count, Symbol after,
+    ValueMap& start, Symbol& entry, Symbol& last_latch) {
+    std::vector<std::unordered_map<Symbol, Symbol>> labels;
+    for (long long k = 0; k < count; ++k) labels.push_back(new_labels(func, c));
+
+    entry = count > 0 ? labels[0].at(c.body_entry) : after;
+    std::vector<BasicBlock> blocks;
+    for (long long k = 0; k < count; ++k) {
+        ValueMap values = start;
+        const Symbol next = k + 1 < count ? labels[k + 1].at(c.body_entry) : after;
+        auto copy = clone_body(func, c, labels[k], values, next);
+        blocks.insert(blocks.end(), copy.begin(), copy.end());
+        for (const auto& phi : c.phis) start[Liveness::keyOf(phi.result)] = lookup(values, phi.from_latch);
+        last_latch = labels[k].at(func.blocks[c.latch].label);
+    }
+    return blocks;
+}
+
+void full_unroll(FunctionIR& func, const CountedLoop& c) {
+    ValueMap final_values;
+    for (const auto& phi : c.phis) final_values[Liveness::keyOf(phi.result)] = phi.from_preheader;
+    Symbol entry, last_latch = func.blocks[c.preheader].label;
+    auto copies = peel(func, c, c.trip, c.exit, final_values, entry, last_latch);
+
+    // 循环外对 header 中 PHI 的使用换成最后的值；出口处 PHI 的入边改为来自最后一份
+    const Symbol header_label = func.blocks[c.header].label;
+    std::set<int> removed(c.body.begin(), c.body.end());
+    removed.insert(c.header);
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        if (removed.count(b)) continue;
+        for (auto& instr : func.blocks[b].instructions) {
+            for_each_use(instr, [&](Operand& op) { op = lookup(final_values, op); });
+            for (auto& arg : instr.phi_args) {
+                if (arg.block == header_label) arg.block = last_latch;
+            }
+        }
+    }
+    retarget(func, c.preheader, header_label, entry);
+
+    std::vector<BasicBlock> blocks;
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        if (b == c.header) {
+            for (auto& bb : copies) blocks.push_back(std::move(bb));
+        }
+        if (!removed.count(b)) blocks.push_back(std::move(func.blocks[b]));
+    }
+    func.blocks = std::move(blocks);
+}
+
+void partial_unroll(FunctionIR& func, const CountedLoop& c, int factor) {
+    const Symbol header_label = func.blocks[c.header].label;
+    const Symbol latch_label = func.blocks[c.latch].label;
+
+    // 1. 剩余的 trip mod factor 次迭代剥离到循环前面
+    ValueMap start;
+    for (const auto& phi : c.phis) start[Liveness::keyOf(phi.result)] = phi.from_preheader;
+    Symbol peel_entry, pre_edge = func.blocks[c.preheader].label;
+    auto peeled = peel(func, c, c.trip % factor, header_label, start, peel_entry, pre_edge);
+
+    // 2. 回边前再接 factor - 1 份循环体
+    std::vector<std::unordered_map<Symbol, Symbol>> labels;
+    for (int k = 1; k < factor; ++k) labels.push_back(new_labels(func, c));
+    ValueMap carried; // 原来的循环体就是第 0 份，它的值不用改名
+    for (const auto& phi : c.phis) carried[Liveness::keyOf(phi.result)] = phi.from_latch;
+    std::vector<BasicBlock> copies;
+    Symbol back_edge = latch_label;
+    for (int k = 1; k < factor; ++k) {
+        ValueMap values = carried;
+        const Symbol next = k + 1 < factor ? labels[k].at(c.body_entry) : header_label;
+        auto copy = clone_body(func, c, labels[k - 1], values, next);
+        copies.insert(copies.end(), copy.begin(), copy.end());
+        for (const auto& phi : c.phis) carried[Liveness::keyOf(phi.result)] = lookup(values, phi.from_latch);
+        back_edge = labels[k - 1].at(latch_label);
+    }
+
+    // 3. header 中 PHI 的两条入边
+    const Symbol pre_label = func.blocks[c.preheader].label;
+    for (auto& instr : func.blocks[c.header].instructions) {
+        if (instr.opcode != Instruction::PHI) break;
+        for (auto& arg : instr.phi_args) {
+            if (arg.block == pre_label) {
+                arg.value = start[Liveness::keyOf(instr.result)];
+                arg.block = pre_edge;
+            }
+            else {
+                arg.value = carried[Liveness::keyOf(instr.result)];
+                arg.block = back_edge;
+            }
+        }
+    }
+    if (!peeled.empty()) retarget(func, c.preheader, header_label, peel_entry);
+    retarget(func, c.latch, header_label, labels[0].at(c.body_entry));
+
+    // 剥离的块放在 header 前，复制的循环体放在原来的回边块后
+    std::vector<BasicBlock> blocks;
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        if (b == c.header) {
+            for (auto& bb : peeled) blocks.push_back(std::move(bb));
+        }
+        blocks.push_back(std::move(func.blocks[b]));
+        if (b == c.latch) {
+            for (auto& bb : copies) blocks.push_back(std::move(bb));
+        }
+    }
+    func.blocks = std::move(blocks);
+}
+
+} // namespace
+
+bool LoopUnrollPass::runOnFunction(FunctionIR& func) {
+    if (!func.in_ssa) return false;
+    bool changed = false;
+    std::set<Symbol> done; // 已处理循环的 header 标签
+    LoopInfo loops;
+
+    for (;;) {
+        loops.compute(func);
+        int l = -1;
+        for (int i = 0; i < (int)loops.loops().size(); ++i) {
+            if (!done.count(func.blocks[loops.loop(i).header].label)) {
+                l = i;
+                break;
+            }
+        }
+        if (l < 0) break;
+        done.insert(func.blocks[loops.loop(l).header].label);
+
+        CountedLoop c;
+        if (!analyze(func, loops, l, c)) continue;
+        if (c.trip * c.size <= kFullUnrollMaxSize) {
+            full_unroll(func, c);
+        }
+        else {
+            int factor = 0;
+            for (int u : kUnrollFactors) {
+                if (u * c.size <= kPartialUnrollMaxSize && c.trip >= u) {
+                    factor = u;
+                    break;
+                }
+            }
+            if (factor == 0) continue;
+            partial_unroll(func, c, factor);
+        }
+        build_cfg(func);
+        changed = true;
+    }
+    return changed;
+}
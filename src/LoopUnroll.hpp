@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class LoopUnrollPass
+ * @brief 计数循环的展开
+ *
+ * 在 SSA 形式上处理最内层的 while 形循环：只从 header 退出，header 中只有 PHI、
+ * 一条 `i OP bound` 比较和条件跳转，i 是初值、步长、边界都为常量的基本归纳变量（见 InductionVariables）。
+ * 这样的循环在编译期就能算出迭代次数 N：
+ *   - N * 循环体大小不超过上限时完全展开：循环体复制 N 份首尾相接，去掉 header 和回边，
+ *     循环外对 header 中 PHI 的使用换成最后一份算出的值；
+ *   - 否则按 U（4 或 2）部分展开：回边前再接 U - 1 份不带条件测试的循环体，
+ *     N mod U 次剩余迭代剥离到循环前面，这样 header 的测试每 U 次迭代做一次仍然准确。
+ * 复制出的常量运算留给之后的 SCCP/GVN/DCE 折叠。
+ */
+class LoopUnrollPass : public FunctionPass {
+public:
+    const char* name() const override { return "unroll"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
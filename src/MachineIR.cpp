@@ -0,0 +1,166 @@
+#include "MachineIR.hpp"
+#include <initializer_list>
+
+namespace {
+
+const char* const kRegNames[NUM_PHYS_REGS] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "fp", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6",
+};
+
+const char* const kOpcodeNames[MachineInstr::NUM_OPCODES] = {
+    "li", "mv", "neg", "not", "seqz", "snez",
+    "add", "sub", "mul", "mulh", "div", "rem", "and", "or", "xor", "sll", "srl", "sra", "slt", "sltu", "sgt",
+    "addi", "andi", "ori", "xori", "slli", "srli", "srai", "slti", "sltiu",
+    "lw", "sw",
+    "beq", "bne", "blt", "bge", "bltu", "bgeu", "beqz", "bnez", "blez", "bgez", "bltz", "bgtz",
+    "j", "call", "tail", "ret",
+};
+
+uint32_t mask_of(std::initializer_list<PhysReg> regs) {
+    uint32_t m = 0;
+    for (PhysReg r : regs) m |= reg_bit(r);
+    return m;
+}
+
+const uint32_t kArgRegs = mask_of({ A0, A1, A2, A3, A4, A5, A6, A7 });
+const uint32_t kCallerSaved = kArgRegs | mask_of({ RA, T0, T1, T2, T3, T4, T5, T6 });
+// 返回时必须保持原值的寄存器
+const uint32_t kPreservedAtExit = mask_of({ RA, SP, FP, S1, S2, S3, S4, S5, S6, S7, S8, S9, S10, S11 });
+
+} // namespace
+
+const char* reg_name(PhysReg r) {
+    return r < NUM_PHYS_REGS ? kRegNames[r] : "?";
+}
+
+const char* opcode_name(MachineInstr::Opcode op) {
+    return kOpcodeNames[op];
+}
+
+MachineInstr::Opcode invert_branch(MachineInstr::Opcode op) {
+    switch (op) {
+    case MachineInstr::BEQ: return MachineInstr::BNE;
+    case MachineInstr::BNE: return MachineInstr::BEQ;
+    case MachineInstr::BLT: return MachineInstr::BGE;
+    case MachineInstr::BGE: return MachineInstr::BLT;
+    case MachineInstr::BLTU: return MachineInstr::BGEU;
+    case MachineInstr::BGEU: return MachineInstr::BLTU;
+    case MachineInstr::BEQZ: return MachineInstr::BNEZ;
+    case MachineInstr::BNEZ: return MachineInstr::BEQZ;
+    case MachineInstr::BLEZ: return MachineInstr::BGTZ;
+    case MachineInstr::BGTZ: return MachineInstr::BLEZ;
+    case MachineInstr::BLTZ: return MachineInstr::BGEZ;
+    case MachineInstr::BGEZ: return MachineInstr::BLTZ;
+    default: return op;
+    }
+}
+
+void canonicalize_branch(MachineInstr& mi) {
+    if (mi.num_ops != 3) return;
+    MachineInstr::Opcode second_zero, first_zero; // 第二个操作数为 zero / 第一个操作数为 zero
+    switch (mi.opcode) {
+    case MachineInstr::BEQ: second_zero = first_zero = MachineInstr::BEQZ; break;
+    case MachineInstr::BNE: second_zero = first_zero = MachineInstr::BNEZ; break;
+    case MachineInstr::BLT: second_zero = MachineInstr::BLTZ; first_zero = MachineInstr::BGTZ; break;
+    case MachineInstr::BGE: second_zero = MachineInstr::BGEZ; first_zero = MachineInstr::BLEZ; break;
+    default: return;
+    }
+    if (mi.ops[1].isReg(ZERO)) mi = MachineInstr(second_zero, mi.ops[0], mi.ops[2]);
+    else if (mi.ops[0].isReg(ZERO)) mi = MachineInstr(first_zero, mi.ops[1], mi.ops[2]);
+}
+
+MachineInstr::MachineInstr(Opcode op, MachineOperand a, MachineOperand b, MachineOperand c)
+    : opcode(op) {
+    ops[0] = a;
+    ops[1] = b;
+    ops[2] = c;
+    num_ops = c.kind != MachineOperand::NONE ? 3 : b.kind != MachineOperand::NONE ? 2 : a.kind != MachineOperand::NONE ? 1 : 0;
+}
+
+bool MachineInstr::definesOp0() const {
+    return opcode <= SLTIU || opcode == LW;
+}
+
+uint32_t MachineInstr::useMask() const {
+    switch (opcode) {
+    case CALL: return kArgRegs;
+    case TAIL: return kArgRegs | kPreservedAtExit;
+    case RET: return reg_bit(A0) | kPreservedAtExit;
+    default: break;
+    }
+    uint32_t m = 0;
+    for (int k = definesOp0() ? 1 : 0; k < num_ops; ++k) {
+        if (ops[k].kind == MachineOperand::REG || ops[k].kind == MachineOperand::MEM) m |= reg_bit(ops[k].reg);
+    }
+    return m;
+}
+
+uint32_t MachineInstr::defMask() const {
+    if (opcode == CALL) return kCallerSaved;
+    return definesOp0() ? reg_bit(ops[0].reg) : 0;
+}
+
+int MachineFunction::internLabel(Symbol label) {
+    auto it = m_label_index.find(label);
+    if (it != m_label_index.end()) return it->second;
+    m_labels.push_back(label);
+    m_label_index.emplace(label, (int)m_labels.size() - 1);
+    return (int)m_labels.size() - 1;
+}
+
+std::vector<uint32_t> machine_live_out(const MachineFunction& mf) {
+    const int nb = (int)mf.blocks.size();
+    std::vector<int> block_of_label(mf.numLabels(), -1);
+    for (int b = 0; b < nb; ++b) {
+        if (mf.blocks[b].label >= 0) block_of_label[mf.blocks[b].label] = b;
+    }
+
+    std::vector<uint32_t> live_in(nb, 0), live_out(nb, 0);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = nb - 1; b >= 0; --b) {
+            const auto& instrs = mf.blocks[b].instrs;
+            uint32_t live = 0;
+            if ((instrs.empty() || !instrs.back().isBarrier()) && b + 1 < nb) live |= live_in[b + 1];
+            if (!instrs.empty() && instrs.back().target() >= 0) {
+                int t = block_of_label[instrs.back().target()];
+                live |= t >= 0 ? live_in[t] : 0xFFFFFFFEu;
+            }
+            live_out[b] = live;
+            for (auto it = instrs.rbegin(); it != instrs.rend(); ++it) {
+                live = (live & ~it->defMask()) | it->useMask();
+            }
+            if (live != live_in[b]) {
+                live_in[b] = live;
+                changed = true;
+            }
+        }
+    }
+    return live_out;
+}
+
+void print_machine_function(const MachineFunction& mf, std::ostream& os) {
+    os << mf.name << ":\n";
+    for (const auto& mbb : mf.blocks) {
+        if (mbb.label >= 0) os << mf.labelName(mbb.label) << ":\n";
+        for (const auto& mi : mbb.instrs) {
+            os << "  " << opcode_name(mi.opcode);
+            for (int k = 0; k < mi.num_ops; ++k) {
+                os << (k ? ", " : " ");
+                const MachineOperand& op = mi.ops[k];
+                switch (op.kind) {
+                case MachineOperand::REG: os << reg_name(op.reg); break;
+                case MachineOperand::IMM: os << op.value; break;
+                case MachineOperand::MEM: os << op.value << "(" << reg_name(op.reg) << ")"; break;
+                case MachineOperand::LABEL: os << mf.labelName(op.value); break;
+                case MachineOperand::NONE: break;
+                }
+            }
+            os << "\n";
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Symbol.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --- 机器级中间表示 ---
+// 代码生成器把 IR 降低为 MachineFunction：按块组织的 RISC-V 指令，操作数是有类型的
+// （物理寄存器 / 立即数 / 基址+偏移 / 标签编号）。窥孔优化等机器级的遍直接改写它，
+// 最后由 print_machine_function 统一打印成汇编文本。
+
+// RV32 整数寄存器，按硬件编号排列；s0 即 fp
+enum PhysReg : uint8_t {
+    ZERO, RA, SP, GP, TP, T0, T1, T2,
+    FP, S1, A0, A1, A2, A3, A4, A5,
+    A6, A7, S2, S3, S4, S5, S6, S7,
+    S8, S9, S10, S11, T3, T4, T5, T6,
+    NUM_PHYS_REGS,
+    NO_REG = 0xFF
+};
+
+const char* reg_name(PhysReg r);
+
+// ILP32 调用约定：前 8 个实参在 a0-a7，其余的从调用时的 sp 开始依次放在栈上，每个占 4 字节
+const int kNumArgRegs = 8;
+inline PhysReg arg_reg(int i) { return PhysReg(A0 + i); }
+inline int stack_arg_offset(int i) { return 4 * (i - kNumArgRegs); }
+// 寄存器集合的位掩码；zero 永远不出现在集合里
+inline uint32_t reg_bit(PhysReg r) { return (r != ZERO && r < NUM_PHYS_REGS) ? 1u << r : 0; }
+
+struct MachineOperand {
+    enum Kind : uint8_t { NONE, REG, IMM, MEM, LABEL };
+    Kind kind = NONE;
+    PhysReg reg = NO_REG; // REG 的寄存器，MEM 的基址
+    int32_t value = 0;    // IMM 的值，MEM 的偏移，LABEL 的标签编号
+
+    static MachineOperand r(PhysReg reg) { return { REG, reg, 0 }; }
+    static MachineOperand imm(int32_t v) { return { IMM, NO_REG, v }; }
+    static MachineOperand mem(int32_t offset, PhysReg base) { return { MEM, base, offset }; }
+    static MachineOperand label(int id) { return { LABEL, NO_REG, id }; }
+
+    bool isReg(PhysReg r) const { return kind == REG && reg == r; }
+    bool operator==(const MachineOperand& o) const { return kind == o.kind && reg == o.reg && value == o.value; }
+    bool operator!=(const MachineOperand& o) const { return !(*this == o); }
+};
+
+struct MachineInstr {
+    enum Opcode : uint8_t {
+        // 伪指令与单操作数运算
+        LI, MV, NEG, NOT, SEQZ, SNEZ,
+        // 寄存器-寄存器运算
+        ADD, SUB, MUL, MULH, DIV, REM, AND, OR, XOR, SLL, SRL, SRA, SLT, SLTU, SGT,
+        // 寄存器-立即数运算
+        ADDI, ANDI, ORI, XORI, SLLI, SRLI, SRAI, SLTI, SLTIU,
+        // 访存
+        LW, SW,
+        // 条件分支：最后一个操作数是标签
+        BEQ, BNE, BLT, BGE, BLTU, BGEU, BEQZ, BNEZ, BLEZ, BGEZ, BLTZ, BGTZ,
+        // 控制转移
+        J, CALL, TAIL, RET,
+        NUM_OPCODES
+    };
+
+    Opcode opcode = RET;
+    uint8_t num_ops = 0;
+    MachineOperand ops[3];
+
+    MachineInstr() = default;
+    MachineInstr(Opcode op, MachineOperand a = MachineOperand(), MachineOperand b = MachineOperand(),
+        MachineOperand c = MachineOperand());
+
+    bool isBranch() const { return opcode >= BEQ && opcode <= BGTZ; }
+    bool isJump() const { return opcode == J; }
+    bool isReturn() const { return opcode == RET || opcode == TAIL; }
+    // 块只能以这些指令结束
+    bool isTerminator() const { return isBranch() || isJump() || isReturn(); }
+    // 之后的指令不会顺序执行到
+    bool isBarrier() const { return isJump() || isReturn(); }
+    // 分支/跳转的目标标签，不是时返回 -1
+    int target() const { return (isBranch() || isJump()) ? ops[num_ops - 1].value : -1; }
+
+    // ops[0] 是否为写入的寄存器
+    bool definesOp0() const;
+    // 读/写的寄存器集合（调用和返回按调用约定计算）
+    uint32_t useMask() const;
+    uint32_t defMask() const;
+};
+
+const char* opcode_name(MachineInstr::Opcode op);
+// 条件分支的反条件（beq <-> bne，blt <-> bge ……）
+MachineInstr::Opcode invert_branch(MachineInstr::Opcode op);
+// 与 zero 比较的双操作数分支改写成对应的单操作数形式（blt x, zero -> bltz x ……）
+void canonicalize_branch(MachineInstr& mi);
+// I 型指令的 12 位有符号立即数
+inline bool fits_imm12(long v) { return v >= -2048 && v <= 2047; }
+
+struct MachineBasicBlock {
+    int label = -1; // 标签编号；-1 表示没有标签（只能从上一块落入）
+    std::vector<MachineInstr> instrs;
+};
+
+// 一个函数的机器代码。块按布局顺序排列，块内只有最后一条指令可以是分支/跳转/返回。
+struct MachineFunction {
+    Symbol name;
+    std::vector<MachineBasicBlock> blocks;
+
+    // 标签与调用目标的名字表，操作数里只存编号
+    int internLabel(Symbol label);
+    const std::string& labelName(int id) const { return m_labels[id].str(); }
+    int numLabels() const { return (int)m_labels.size(); }
+
+private:
+    std::vector<Symbol> m_labels;
+    std::unordered_map<Symbol, int> m_label_index;
+};
+
+// 每个块出口处活跃的寄存器集合（位掩码，见 reg_bit）。
+// 跳到未知标签时保守地认为所有寄存器都活跃。
+std::vector<uint32_t> machine_live_out(const MachineFunction& mf);
+
+void print_machine_function(const MachineFunction& mf, std::ostream& os);
@@ -1 +1,109 @@
-//
\ No newline at end of file
+#include "Optimizer.hpp"
+#include "CFG.hpp"
+#include "SSA.hpp"
+#include "SCCP.hpp"
+#include "DCE.hpp"
+#include "GVN.hpp"
+#include "LICM.hpp"
+#include "LoopStrengthReduction.hpp"
+#include "LoopUnroll.hpp"
+#include "LoopRotation.hpp"
+#include "Inliner.hpp"
+#include "TailCall.hpp"
+#include <chrono>
+#include <iomanip>
+
+bool FunctionPass::runOnModule(ModuleIR& module) {
+    bool changed = false;
+    for (auto& func : module.functions) {
+        if (runOnFunction(func)) {
+            // 保证后续的遍看到的控制流图与 IR 一致
+            build_cfg(func);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+long count_instructions(const ModuleIR& module) {
+    long n = 0;
+    for (const auto& func : module.functions) {
+        for (const auto& bb : func.blocks) {
+            n += (long)bb.instructions.size();
+        }
+    }
+    return n;
+}
+
+Optimizer::Optimizer(OptLevel level) : m_level(level) {
+    buildPipeline();
+}
+
+// 根据优化级别组装流水线
+void Optimizer::buildPipeline() {
+    if (m_level == OptLevel::O0) return;
+
+    addPass(std::make_unique<TailCallPass>(TailCallPass::Mode::SelfRecursion));
+    addPass(std::make_unique<InlinerPass>());
+    addPass(std::make_unique<SSAConstructionPass>());
+    // 基于 SSA 的遍按执行顺序加在这里
+    addPass(std::make_unique<SCCPPass>());
+    addPass(std::make_unique<GVNPass>());
+    addPass(std::make_unique<LICMPass>());
+    addPass(std::make_unique<LoopStrengthReductionPass>());
+    if (m_level == OptLevel::O2) {
+        // 展开会增大代码，只在 -O2 做；复制出的常量运算再折叠一遍
+        addPass(std::make_unique<LoopUnrollPass>());
+        addPass(std::make_unique<SCCPPass>());
+        addPass(std::make_unique<GVNPass>());
+    }
+    addPass(std::make_unique<DeadCodeEliminationPass>());
+    addPass(std::make_unique<SSADestructionPass>());
+    addPass(std::make_unique<LoopRotationPass>());
+    addPass(std::make_unique<TailCallPass>(TailCallPass::Mode::AllCalls));
+}
+
+void Optimizer::addPass(std::unique_ptr<Pass> pass) {
+    m_passes.push_back(std::move(pass));
+    m_stats.emplace_back();
+}
+
+bool Optimizer::run(ModuleIR& module) {
+    bool changed = false;
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        PassStats& stats = m_stats[i];
+        const long before = count_instructions(module);
+        auto start = std::chrono::steady_clock::now();
+
+        bool pass_changed = m_passes[i]->runOnModule(module);
+
+        auto end = std::chrono::steady_clock::now();
+        stats.seconds += std::chrono::duration<double>(end - start).count();
+        stats.runs++;
+        if (pass_changed) {
+            stats.changes++;
+            stats.instr_delta += count_instructions(module) - before;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void Optimizer::printStats(std::ostream& os) const {
+    double total = 0.0;
+    for (const auto& stats : m_stats) total += stats.seconds;
+
+    os << "===== Pass execution timing report =====\n";
+    os << std::left << std::setw(24) << "Pass" << std::right
+        << std::setw(12) << "Time(ms)" << std::setw(8) << "Runs"
+        << std::setw(10) << "Changed" << std::setw(12) << "Instrs+/-" << "\n";
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        const PassStats& stats = m_stats[i];
+        os << std::left << std::setw(24) << m_passes[i]->name() << std::right
+            << std::setw(12) << std::fixed << std::setprecision(3) << stats.seconds * 1000.0
+            << std::setw(8) << stats.runs << std::setw(10) << stats.changes
+            << std::setw(12) << stats.instr_delta << "\n";
+    }
+    os << std::left << std::setw(24) << "Total" << std::right
+        << std::setw(12) << std::fixed << std::setprecision(3) << total * 1000.0 << "\n";
+}
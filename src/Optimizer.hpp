@@ -1 +1,66 @@
-//
\ No newline at end of file
+#pragma once
+
+#include "ir.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 优化级别：-O0 不做优化，-O1 / -O2 依次打开更多的遍
+enum class OptLevel { O0, O1, O2 };
+
+// 优化遍的基类：在整个模块上运行，返回 true 表示修改了 IR
+class Pass {
+public:
+    virtual ~Pass() = default;
+    virtual const char* name() const = 0;
+    virtual bool runOnModule(ModuleIR& module) = 0;
+};
+
+// 函数级优化遍：逐个函数运行。
+// runOnFunction 返回 true 后会重建该函数的控制流图；
+// 遍内部如果先改了控制流又要用到边或支配树，需要自己调用 build_cfg。
+class FunctionPass : public Pass {
+public:
+    bool runOnModule(ModuleIR& module) override;
+    virtual bool runOnFunction(FunctionIR& func) = 0;
+};
+
+/**
+ * @class Optimizer
+ * @brief 优化遍管理器
+ *
+ * 按顺序运行一条可配置的优化流水线，并记录每个遍的耗时、
+ * 修改 IR 的次数以及指令数的变化，便于权衡编译时间与生成代码的速度。
+ */
+class Optimizer {
+public:
+    explicit Optimizer(OptLevel level);
+
+    void addPass(std::unique_ptr<Pass> pass);
+
+    // 运行整条流水线；返回 true 表示 IR 被修改过
+    bool run(ModuleIR& module);
+
+    // 打印每个遍的统计信息（-time-passes）
+    void printStats(std::ostream& os) const;
+
+    OptLevel level() const { return m_level; }
+
+private:
+    struct PassStats {
+        int runs = 0;
+        int changes = 0;        // 返回“已修改”的次数
+        long instr_delta = 0;   // 指令数变化（负数表示删掉了指令）
+        double seconds = 0.0;
+    };
+
+    void buildPipeline();
+
+    OptLevel m_level;
+    std::vector<std::unique_ptr<Pass>> m_passes;
+    std::vector<PassStats> m_stats; // 与 m_passes 一一对应
+};
+
+// 统计模块中的指令条数
+long count_instructions(const ModuleIR& module);
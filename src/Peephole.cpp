@@ -0,0 +1,368 @@
+#include "Peephole.hpp"
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+using MI = MachineInstr;
+using MO = MachineOperand;
+
+// 块内每条指令之后活跃的寄存器集合
+std::vector<uint32_t> live_after(const MachineBasicBlock& mbb, uint32_t live_out) {
+    const auto& instrs = mbb.instrs;
+    std::vector<uint32_t> after(instrs.size());
+    uint32_t live = live_out;
+    for (int i = (int)instrs.size() - 1; i >= 0; --i) {
+        after[i] = live;
+        live = (live & ~instrs[i].defMask()) | instrs[i].useMask();
+    }
+    return after;
+}
+
+void erase_marked(std::vector<MachineInstr>& instrs, const std::vector<bool>& dead) {
+    size_t out = 0;
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        if (!dead[i]) instrs[out++] = instrs[i];
+    }
+    instrs.resize(out);
+}
+
+void set_target(MachineInstr& mi, int label) {
+    mi.ops[mi.num_ops - 1].value = label;
+}
+
+// 整理块的划分：空的带标签块把标签让给后面的块，没有标签的块并入上一块
+// （上一块不以分支/跳转结束时），空块删掉
+void merge_blocks(MachineFunction& mf) {
+    auto& blocks = mf.blocks;
+    for (size_t b = 0; b + 1 < blocks.size(); ++b) {
+        if (blocks[b].instrs.empty() && blocks[b].label >= 0 && blocks[b + 1].label < 0) {
+            std::swap(blocks[b].label, blocks[b + 1].label);
+        }
+    }
+    size_t out = 0;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        MachineBasicBlock& mbb = blocks[b];
+        if (mbb.label < 0 && out > 0) {
+            auto& prev = blocks[out - 1].instrs;
+            if (prev.empty() || !prev.back().isTerminator()) {
+                prev.insert(prev.end(), mbb.instrs.begin(), mbb.instrs.end());
+                continue;
+            }
+        }
+        if (mbb.label < 0 && mbb.instrs.empty()) continue;
+        if (out != b) blocks[out] = std::move(mbb);
+        ++out;
+    }
+    blocks.resize(out);
+}
+
+} // namespace
+
+// sw rX, off(b) 之后、b 和 rX 被改写或遇到别的存储/调用/块尾之前，
+// 从同一地址的装载可以直接用 rX
+bool PeepholeOptimizer::storeLoad(MachineFunction& mf) {
+    bool changed = false;
+    for (auto& mbb : mf.blocks) {
+        auto& instrs = mbb.instrs;
+        std::vector<bool> dead(instrs.size(), false);
+        for (size_t i = 0; i < instrs.size(); ++i) {
+            const MI& st = instrs[i];
+            if (st.opcode != MI::SW || dead[i]) continue;
+            const uint32_t clobber = reg_bit(st.ops[0].reg) | reg_bit(st.ops[1].reg);
+            for (size_t j = i + 1; j < instrs.size(); ++j) {
+                MI& mi = instrs[j];
+                if (mi.opcode == MI::LW && mi.ops[1] == st.ops[1]) {
+                    if (mi.ops[0].reg == st.ops[0].reg) dead[j] = true;
+                    else mi = MI(MI::MV, mi.ops[0], st.ops[0]);
+                    m_hits[StoreLoad]++;
+                    changed = true;
+                    break;
+                }
+                if (mi.opcode == MI::SW || mi.opcode == MI::CALL || mi.isTerminator() || (mi.defMask() & clobber)) break;
+            }
+        }
+        erase_marked(instrs, dead);
+    }
+    return changed;
+}
+
+// j L 后面紧跟 L:（中间可以隔着空块）
+bool PeepholeOptimizer::jumpNext(MachineFunction& mf) {
+    bool changed = false;
+    const int nb = (int)mf.blocks.size();
+    for (int b = 0; b < nb; ++b) {
+        auto& instrs = mf.blocks[b].instrs;
+        if (instrs.empty() || !instrs.back().isJump()) continue;
+        const int target = instrs.back().target();
+        for (int c = b + 1; c < nb; ++c) {
+            if (mf.blocks[c].label == target) {
+                instrs.pop_back();
+                m_hits[JumpNext]++;
+                changed = true;
+                break;
+            }
+            if (!mf.blocks[c].instrs.empty()) break;
+        }
+    }
+    return changed;
+}
+
+// bcc L1; j L2; L1:  =>  b!cc L2; L1:
+bool PeepholeOptimizer::branchInvert(MachineFunction& mf) {
+    bool changed = false;
+    const int nb = (int)mf.blocks.size();
+    for (int b = 0; b + 2 < nb; ++b) {
+        auto& instrs = mf.blocks[b].instrs;
+        MachineBasicBlock& jb = mf.blocks[b + 1];
+        if (instrs.empty() || !instrs.back().isBranch()) continue;
+        if (jb.label >= 0 || jb.instrs.size() != 1 || !jb.instrs[0].isJump()) continue;
+        const int l1 = instrs.back().target();
+        int c = b + 2;
+        while (c < nb && mf.blocks[c].label != l1 && mf.blocks[c].instrs.empty()) ++c;
+        if (c >= nb || mf.blocks[c].label != l1) continue;
+        MI& br = instrs.back();
+        br.opcode = invert_branch(br.opcode);
+        set_target(br, jb.instrs[0].target());
+        jb.instrs.clear();
+        m_hits[BranchInvert]++;
+        changed = true;
+    }
+    return changed;
+}
+
+// 跳转目标处第一条指令是 j L 时，直接跳到 L
+bool PeepholeOptimizer::jumpThread(MachineFunction& mf) {
+    std::vector<int> forward(mf.numLabels(), -1);
+    for (const auto& mbb : mf.blocks) {
+        if (mbb.label >= 0 && !mbb.instrs.empty() && mbb.instrs[0].isJump()) {
+            forward[mbb.label] = mbb.instrs[0].target();
+        }
+    }
+    bool changed = false;
+    for (auto& mbb : mf.blocks) {
+        if (mbb.instrs.empty() || mbb.instrs.back().target() < 0) continue;
+        MI& mi = mbb.instrs.back();
+        int target = mi.target();
+        // 沿链条走到底；步数有限，防止 j 自身构成的死循环
+        for (int step = 0; step < mf.numLabels(); ++step) {
+            const int next = forward[target];
+            if (next < 0 || next == target) break;
+            target = next;
+        }
+        if (target != mi.target()) {
+            set_target(mi, target);
+            m_hits[JumpThread]++;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// 去掉没有被引用的标签（函数名由打印器单独输出，不在块标签里）
+bool PeepholeOptimizer::deadLabel(MachineFunction& mf) {
+    std::vector<bool> referenced(mf.numLabels(), false);
+    for (const auto& mbb : mf.blocks) {
+        if (!mbb.instrs.empty() && mbb.instrs.back().target() >= 0) referenced[mbb.instrs.back().target()] = true;
+    }
+    bool changed = false;
+    for (auto& mbb : mf.blocks) {
+        if (mbb.label >= 0 && !referenced[mbb.label]) {
+            mbb.label = -1;
+            m_hits[DeadLabel]++;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// 没有标签、上一块又不会落入的块永远不会执行
+bool PeepholeOptimizer::unreachable(MachineFunction& mf) {
+    bool changed = false;
+    bool falls_in = true;
+    for (auto& mbb : mf.blocks) {
+        if (mbb.label < 0 && !falls_in) {
+            if (!mbb.instrs.empty()) {
+                m_hits[Unreachable] += (long)mbb.instrs.size();
+                mbb.instrs.clear();
+                changed = true;
+            }
+            continue;
+        }
+        falls_in = mbb.instrs.empty() || !mbb.instrs.back().isBarrier();
+    }
+    return changed;
+}
+
+// 块尾的 beqz/bnez 只检查紧挨着的比较结果，且结果在分支之后不再活跃时，合成一条比较分支
+bool PeepholeOptimizer::branchFuse(MachineFunction& mf) {
+    const std::vector<uint32_t> live_out = machine_live_out(mf);
+    bool changed = false;
+    for (size_t b = 0; b < mf.blocks.size(); ++b) {
+        auto& instrs = mf.blocks[b].instrs;
+        if (instrs.empty()) continue;
+        const MI br = instrs.back();
+        if (br.opcode != MI::BEQZ && br.opcode != MI::BNEZ) continue;
+        const PhysReg rd = br.ops[0].reg;
+        if (rd == ZERO || (live_out[b] & reg_bit(rd))) continue;
+
+        auto defines_rd = [&](int i, MI::Opcode op) {
+            return i >= 0 && instrs[i].opcode == op && instrs[i].ops[0].isReg(rd);
+        };
+        int i = (int)instrs.size() - 2;
+        bool negate = false;
+        if (defines_rd(i, MI::XORI) && instrs[i].ops[1].isReg(rd) && instrs[i].ops[2] == MO::imm(1)) {
+            negate = true;
+            --i;
+        }
+        if (i < 0 || !instrs[i].definesOp0() || !instrs[i].ops[0].isReg(rd)) continue;
+
+        const MI& cmp = instrs[i];
+        int first = i;
+        MI::Opcode op;
+        MO x = cmp.ops[1], y = cmp.ops[2];
+        bool unary = false;
+        switch (cmp.opcode) {
+        case MI::SLT: op = MI::BLT; break;
+        case MI::SLTU: op = MI::BLTU; break;
+        case MI::SGT: op = MI::BLT; std::swap(x, y); break;
+        case MI::SUB:
+            // 差不为 0 即两者不等；差不是布尔值，不能再取反
+            if (negate) continue;
+            op = MI::BNE;
+            break;
+        case MI::SEQZ: case MI::SNEZ:
+            if (cmp.ops[1].isReg(rd) && defines_rd(i - 1, MI::SUB)) {
+                op = cmp.opcode == MI::SEQZ ? MI::BEQ : MI::BNE;
+                x = instrs[i - 1].ops[1];
+                y = instrs[i - 1].ops[2];
+                first = i - 1;
+            }
+            else {
+                op = cmp.opcode == MI::SEQZ ? MI::BEQZ : MI::BNEZ;
+                unary = true;
+            }
+            break;
+        default:
+            continue;
+        }
+        if (negate != (br.opcode == MI::BEQZ)) op = invert_branch(op);
+        MI fused = unary ? MI(op, x, br.ops[1]) : MI(op, x, y, br.ops[1]);
+        canonicalize_branch(fused);
+        instrs.resize(first);
+        instrs.push_back(fused);
+        m_hits[BranchFuse]++;
+        changed = true;
+    }
+    return changed;
+}
+
+// li rA, imm 的唯一使用是下一条引用 rA 的指令，且 rA 之后不再活跃时，把常量折进那条指令
+bool PeepholeOptimizer::liFold(MachineFunction& mf) {
+    const std::vector<uint32_t> live_out = machine_live_out(mf);
+    bool changed = false;
+    for (size_t b = 0; b < mf.blocks.size(); ++b) {
+        auto& instrs = mf.blocks[b].instrs;
+        const std::vector<uint32_t> live = live_after(mf.blocks[b], live_out[b]);
+        std::vector<bool> dead(instrs.size(), false);
+        for (size_t i = 0; i < instrs.size(); ++i) {
+            const MI& li = instrs[i];
+            if (li.opcode != MI::LI || li.ops[0].isReg(ZERO)) continue;
+            const PhysReg ra = li.ops[0].reg;
+            const uint32_t ra_bit = reg_bit(ra);
+            const long imm = li.ops[1].value;
+
+            // 同一个块里第一条引用 rA 的指令
+            size_t j = i + 1;
+            while (j < instrs.size() && !((instrs[j].useMask() | instrs[j].defMask()) & ra_bit)) ++j;
+            if (j >= instrs.size()) continue;
+            MI& u = instrs[j];
+            if (!(u.useMask() & ra_bit)) continue;
+            if ((live[j] & ra_bit) && !(u.defMask() & ra_bit)) continue;
+
+            int uses = 0;
+            for (int k = u.definesOp0() ? 1 : 0; k < u.num_ops; ++k) {
+                const MO& op = u.ops[k];
+                if ((op.kind == MO::REG || op.kind == MO::MEM) && op.reg == ra) ++uses;
+            }
+            if (uses != 1) continue;
+
+            MI::Opcode imm_form;
+            switch (u.opcode) {
+            case MI::ADD: imm_form = MI::ADDI; break;
+            case MI::SLT: imm_form = MI::SLTI; break;
+            case MI::SLTU: imm_form = MI::SLTIU; break;
+            case MI::XOR: imm_form = MI::XORI; break;
+            case MI::AND: imm_form = MI::ANDI; break;
+            case MI::OR: imm_form = MI::ORI; break;
+            default: imm_form = u.opcode; break;
+            }
+            const bool commutative = u.opcode == MI::ADD || u.opcode == MI::XOR || u.opcode == MI::AND || u.opcode == MI::OR;
+
+            bool folded = true;
+            if (u.opcode == MI::MV) {
+                u = MI(MI::LI, u.ops[0], li.ops[1]);
+            }
+            else if (imm_form != u.opcode && u.ops[2].isReg(ra) && fits_imm12(imm)) {
+                u = MI(imm_form, u.ops[0], u.ops[1], li.ops[1]);
+            }
+            else if (commutative && u.ops[1].isReg(ra) && fits_imm12(imm)) {
+                u = MI(imm_form, u.ops[0], u.ops[2], li.ops[1]);
+            }
+            else if (u.opcode == MI::SUB && u.ops[2].isReg(ra) && fits_imm12(-imm)) {
+                u = MI(MI::ADDI, u.ops[0], u.ops[1], MO::imm((int32_t)-imm));
+            }
+            else if (u.opcode == MI::SGT && u.ops[1].isReg(ra) && fits_imm12(imm)) {
+                // imm > x  <=>  x < imm
+                u = MI(MI::SLTI, u.ops[0], u.ops[2], li.ops[1]);
+            }
+            else if (imm == 0 && u.isBranch()) {
+                // 常量 0 直接用 zero 寄存器
+                for (int k = 0; k + 1 < u.num_ops; ++k) {
+                    if (u.ops[k].isReg(ra)) u.ops[k].reg = ZERO;
+                }
+                canonicalize_branch(u);
+            }
+            else if (imm == 0 && u.opcode == MI::SW && u.ops[0].isReg(ra)) {
+                u.ops[0].reg = ZERO;
+            }
+            else {
+                folded = false;
+            }
+            if (!folded) continue;
+            dead[i] = true;
+            m_hits[LiFold]++;
+            changed = true;
+        }
+        erase_marked(instrs, dead);
+    }
+    return changed;
+}
+
+void PeepholeOptimizer::run(MachineFunction& mf) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        changed |= storeLoad(mf);
+        changed |= jumpThread(mf);
+        changed |= deadLabel(mf);
+        changed |= unreachable(mf);
+        changed |= jumpNext(mf);
+        changed |= branchInvert(mf);
+        // 先合并分支再折叠常量：比较 0 的分支可以进一步变成 bltz/bgez 之类
+        changed |= branchFuse(mf);
+        changed |= liFold(mf);
+
+        merge_blocks(mf);
+    }
+}
+
+void PeepholeOptimizer::printStats(std::ostream& os) const {
+    static const char* const names[NumRules] = {
+        "store-load", "jump-next", "branch-invert", "jump-thread", "dead-label", "unreachable", "li-fold", "branch-fuse",
+    };
+    os << "===== Peephole statistics =====\n";
+    for (int r = 0; r < NumRules; ++r) {
+        os << std::left << std::setw(24) << names[r] << std::right << std::setw(8) << m_hits[r] << "\n";
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "MachineIR.hpp"
+#include <ostream>
+
+/**
+ * @class PeepholeOptimizer
+ * @brief 机器级窥孔优化
+ *
+ * 直接改写代码生成器产生的 MachineFunction，需要时在机器基本块上做寄存器级的活跃分析，
+ * 反复应用下面几条规则直到不再变化：
+ *   - store-load：`sw rX, off(b)` 后紧跟 `lw rY, off(b)`，去掉装载或换成 mv；
+ *   - jump-next：跳到紧随其后的标签的 `j`；
+ *   - branch-invert：`bcc L1; j L2; L1:` 换成一条反条件的 `b!cc L2`；
+ *   - jump-thread：跳到一条 `j L` 上的跳转/分支直接改成跳到 L；
+ *   - dead-label：没有任何跳转引用的标签（去掉后上面几条才能看到相邻关系）；
+ *   - unreachable：无条件跳转/返回之后、下一个标签之前的指令；
+ *   - li-fold：`li` 装入的常量只被一条 add/sub/slt/xor/and/or/mv 使用且之后不再活跃时，
+ *     折叠成 addi/slti/xori/andi/ori/li；
+ *   - branch-fuse：比较（slt/sgt/sub，sub 后可带 seqz/snez，可带 xori 取反）后接 beqz/bnez，
+ *     比较结果在分支之后不再活跃时，合并成一条 blt/bge/beq/bne。
+ * 每条规则命中的次数累计在优化器里，可以用 printStats 打印。
+ */
+class PeepholeOptimizer {
+public:
+    enum Rule { StoreLoad, JumpNext, BranchInvert, JumpThread, DeadLabel, Unreachable, LiFold, BranchFuse, NumRules };
+
+    void run(MachineFunction& mf);
+
+    void printStats(std::ostream& os) const;
+
+private:
+    bool storeLoad(MachineFunction& mf);
+    bool jumpNext(MachineFunction& mf);
+    bool branchInvert(MachineFunction& mf);
+    bool jumpThread(MachineFunction& mf);
+    bool deadLabel(MachineFunction& mf);
+    bool unreachable(MachineFunction& mf);
+    bool liFold(MachineFunction& mf);
+    bool branchFuse(MachineFunction& mf);
+
+    long m_hits[NumRules] = {};
+};
@@ -1,37 +1,64 @@
 #pragma once
 
 #include "ir.hpp"
+#include "MachineIR.hpp"
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <map>
+#include <algorithm>
 
-// һṹʾλ
-// δչ Reg(Ĵ), Imm() 
+// 定义一个结构体来表示操作数的位置
+// 未来可以扩展，比如增加 Imm(立即数) 等
 struct OperandLocation {
-    enum Kind { STACK };
+    enum Kind { STACK, REG };
     Kind kind;
-    int offset; //  STACK ͣʾ fp ·ƫ
+    int offset;  // 对于 STACK 类型，表示相对 sp 的偏移量
+    PhysReg reg; // 对于 REG 类型，表示常驻的物理寄存器
 };
 
+// 传出参数区的大小：函数里实参最多的一次调用放在栈上的那部分。
+// 这块区域在栈帧的最底部（从 sp 开始），调用前直接写入，不必临时调整 sp
+inline int outgoing_args_size(const FunctionIR& func) {
+    int size = 0;
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            if (instr.opcode == Instruction::CALL && instr.arg2.value > kNumArgRegs) {
+                size = std::max(size, stack_arg_offset(instr.arg2.value));
+            }
+        }
+    }
+    return size;
+}
+
+// 生成的机器指令都追加到 out 的末尾
 class RegisterAllocator {
 public:
     virtual ~RegisterAllocator() = default;
 
-    // 1. (׼׶) ջֵ֡
-    virtual void prepare(const FunctionIR& func) = 0;
+    // 1. (准备阶段) 分析整个函数，计算栈帧布局等。
+    //    folded 是指令选择时被模式吸收、从不写出的值，不必为它们分配寄存器或栈槽
+    virtual void prepare(const FunctionIR& func, const std::unordered_set<ValueKey>& folded) = 0;
+
+    // 2. (序言) 生成函数的序言代码
+    virtual void emitPrologue(std::vector<MachineInstr>& out) = 0;
 
-    // 2. () ȡΪɵԴ
-    virtual std::string getPrologue() = 0;
+    // 3. (尾声) 生成函数的尾声代码
+    virtual void emitEpilogue(std::vector<MachineInstr>& out) = 0;
 
-    // 3. (β) ȡΪɵβ
-    virtual std::string getEpilogue() = 0;
+    // 3.1 (拆帧) 尾声中除 ret 以外的部分：恢复寄存器并释放栈帧，尾调用在其后直接跳走
+    virtual void emitTeardown(std::vector<MachineInstr>& out) = 0;
 
-    // 4. () ɽһصָĴĴ
-    virtual std::string loadOperand(const Operand& op, const std::string& destReg) = 0;
+    // 4. (加载) 生成将一个操作数加载到指定物理寄存器的代码
+    virtual void loadOperand(const Operand& op, PhysReg destReg, std::vector<MachineInstr>& out) = 0;
 
-    // 5. (洢) ɽһĴֵزλõĴ
-    virtual std::string storeOperand(const Operand& result, const std::string& srcReg) = 0;
+    // 5. (存储) 生成将一个物理寄存器的值存回操作数所在位置的代码
+    virtual void storeOperand(const Operand& result, PhysReg srcReg, std::vector<MachineInstr>& out) = 0;
 
-    // (ѡ) ȡջ֡Сڲݵ
+    // (可选) 获取总栈帧大小，用于参数传递等
     virtual int getTotalStackSize() const = 0;
-};
\ No newline at end of file
+
+    // 6. (查询) 操作数常驻的物理寄存器；在栈上或是常量时返回 NO_REG。
+    //    代码生成器据此直接使用该寄存器，省去 load/store
+    virtual PhysReg getRegister(const Operand& op) const { return NO_REG; }
+};
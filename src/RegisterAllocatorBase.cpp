@@ -0,0 +1,187 @@
+#include "RegisterAllocatorBase.hpp"
+#include <algorithm>
+
+const std::vector<PhysReg>& RegisterAllocatorBase::calleeSavedRegs() {
+    static const std::vector<PhysReg> regs = { S1, S2, S3, S4, S5, S6, S7, S8, S9, S10, S11, FP };
+    return regs;
+}
+
+bool RegisterAllocatorBase::isCalleeSaved(PhysReg reg) {
+    return reg == FP || reg == S1 || (reg >= S2 && reg <= S11);
+}
+
+void RegisterAllocatorBase::prepare(const FunctionIR& func, const std::unordered_set<ValueKey>& folded) {
+    bool calls = false, tail_calls = false;
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            calls = calls || instr.opcode == Instruction::CALL;
+            tail_calls = tail_calls || instr.opcode == Instruction::TAIL_CALL;
+        }
+    }
+    // 尾调用直接跳走，ra 原样留给被调用者，所以只有普通调用才需要保存 ra
+    m_saves_ra = calls;
+    m_caller_saved = { T3, T4, T5, T6 };
+    if (!calls && !tail_calls) {
+        for (int i = (int)func.params.size(); i < 8; ++i) m_caller_saved.push_back(arg_reg(i));
+    }
+
+    m_liveness.compute(func);
+    m_assigned.assign(m_liveness.numValues(), NO_REG);
+    m_folded.assign(m_liveness.numValues(), false);
+    for (int v = 0; v < m_liveness.numValues(); ++v) {
+        m_folded[v] = folded.count(Liveness::keyOf(m_liveness.valueAt(v))) != 0;
+    }
+    assignRegisters(func);
+    layoutFrame(func);
+}
+
+void RegisterAllocatorBase::layoutFrame(const FunctionIR& func) {
+    const int nv = m_liveness.numValues();
+    m_locations.assign(nv, OperandLocation{ OperandLocation::STACK, 0, NO_REG });
+    m_used_callee_saved.clear();
+    m_callee_saved_offsets.clear();
+
+    // 通过栈传进来的参数（第 9 个起）：溢出时直接用调用者栈帧里的那个位置，不另占栈槽
+    std::vector<int> stack_param(nv, -1);
+    for (size_t i = kNumArgRegs; i < func.params.size(); ++i) {
+        Operand op;
+        op.kind = Operand::VAR;
+        op.name = func.params[i].name;
+        int idx = m_liveness.indexOf(op);
+        if (idx >= 0) stack_param[idx] = (int)i;
+    }
+
+    // 栈帧从 sp 往上：传出参数区、溢出槽、用到的被调用者保存寄存器、ra
+    int current_offset = outgoing_args_size(func);
+    for (int v = 0; v < nv; ++v) {
+        if (m_folded[v]) continue;
+        if (m_assigned[v] != NO_REG) {
+            m_locations[v].kind = OperandLocation::REG;
+            m_locations[v].reg = m_assigned[v];
+        }
+        else if (stack_param[v] < 0) {
+            m_locations[v].offset = current_offset;
+            current_offset += 4;
+        }
+    }
+    std::vector<bool> used(NUM_PHYS_REGS, false);
+    for (int v = 0; v < nv; ++v) {
+        if (!m_folded[v] && m_assigned[v] != NO_REG) used[m_assigned[v]] = true;
+    }
+    for (const auto& reg : calleeSavedRegs()) {
+        if (used[reg]) {
+            m_used_callee_saved.push_back(reg);
+            m_callee_saved_offsets.push_back(current_offset);
+            current_offset += 4;
+        }
+    }
+    if (m_saves_ra) {
+        m_ra_offset = current_offset;
+        current_offset += 4;
+    }
+
+    m_total_stack_size = current_offset;
+    // 16字节对齐
+    if (m_total_stack_size % 16 != 0) {
+        m_total_stack_size += 16 - (m_total_stack_size % 16);
+    }
+    for (int v = 0; v < nv; ++v) {
+        if (stack_param[v] >= 0 && m_assigned[v] == NO_REG && !m_folded[v]) {
+            m_locations[v].offset = m_total_stack_size + stack_arg_offset(stack_param[v]);
+        }
+    }
+
+    // 只有入口处活跃的参数才需要从 a0-a7 / 栈上取出
+    m_param_init_code.clear();
+    for (size_t i = 0; i < func.params.size(); ++i) {
+        Operand op;
+        op.kind = Operand::VAR;
+        op.name = func.params[i].name;
+        int idx = m_liveness.indexOf(op);
+        if (idx < 0 || m_liveness.numBlocks() == 0 || !m_liveness.liveIn(0)[idx]) continue;
+        const OperandLocation& loc = m_locations[idx];
+        if (i >= (size_t)kNumArgRegs) {
+            if (loc.kind == OperandLocation::REG) {
+                m_param_init_code.emplace_back(MachineInstr::LW, MachineOperand::r(loc.reg),
+                    MachineOperand::mem(m_total_stack_size + stack_arg_offset((int)i), SP));
+            }
+        }
+        else if (loc.kind == OperandLocation::REG) {
+            m_param_init_code.emplace_back(MachineInstr::MV, MachineOperand::r(loc.reg), MachineOperand::r(arg_reg((int)i)));
+        }
+        else {
+            m_param_init_code.emplace_back(MachineInstr::SW, MachineOperand::r(arg_reg((int)i)), MachineOperand::mem(loc.offset, SP));
+        }
+    }
+}
+
+const OperandLocation* RegisterAllocatorBase::locationOf(const Operand& op) const {
+    int idx = m_liveness.indexOf(op);
+    if (idx < 0 || idx >= (int)m_locations.size() || m_folded[idx]) return nullptr;
+    return &m_locations[idx];
+}
+
+void RegisterAllocatorBase::emitPrologue(std::vector<MachineInstr>& out) {
+    if (m_total_stack_size > 0) {
+        out.emplace_back(MachineInstr::ADDI, MachineOperand::r(SP), MachineOperand::r(SP), MachineOperand::imm(-m_total_stack_size));
+    }
+    if (m_saves_ra) {
+        out.emplace_back(MachineInstr::SW, MachineOperand::r(RA), MachineOperand::mem(m_ra_offset, SP));
+    }
+    for (size_t i = 0; i < m_used_callee_saved.size(); ++i) {
+        out.emplace_back(MachineInstr::SW, MachineOperand::r(m_used_callee_saved[i]), MachineOperand::mem(m_callee_saved_offsets[i], SP));
+    }
+    out.insert(out.end(), m_param_init_code.begin(), m_param_init_code.end());
+}
+
+void RegisterAllocatorBase::emitEpilogue(std::vector<MachineInstr>& out) {
+    emitTeardown(out);
+    out.emplace_back(MachineInstr::RET);
+}
+
+void RegisterAllocatorBase::emitTeardown(std::vector<MachineInstr>& out) {
+    for (size_t i = 0; i < m_used_callee_saved.size(); ++i) {
+        out.emplace_back(MachineInstr::LW, MachineOperand::r(m_used_callee_saved[i]), MachineOperand::mem(m_callee_saved_offsets[i], SP));
+    }
+    if (m_saves_ra) {
+        out.emplace_back(MachineInstr::LW, MachineOperand::r(RA), MachineOperand::mem(m_ra_offset, SP));
+    }
+    if (m_total_stack_size > 0) {
+        out.emplace_back(MachineInstr::ADDI, MachineOperand::r(SP), MachineOperand::r(SP), MachineOperand::imm(m_total_stack_size));
+    }
+}
+
+void RegisterAllocatorBase::loadOperand(const Operand& op, PhysReg destReg, std::vector<MachineInstr>& out) {
+    if (op.kind == Operand::CONST) {
+        out.emplace_back(MachineInstr::LI, MachineOperand::r(destReg), MachineOperand::imm(op.value));
+    }
+    else if (const OperandLocation* loc = locationOf(op)) {
+        if (loc->kind == OperandLocation::REG) {
+            if (loc->reg != destReg) out.emplace_back(MachineInstr::MV, MachineOperand::r(destReg), MachineOperand::r(loc->reg));
+        }
+        else {
+            out.emplace_back(MachineInstr::LW, MachineOperand::r(destReg), MachineOperand::mem(loc->offset, SP));
+        }
+    }
+}
+
+void RegisterAllocatorBase::storeOperand(const Operand& result, PhysReg srcReg, std::vector<MachineInstr>& out) {
+    if (const OperandLocation* loc = locationOf(result)) {
+        if (loc->kind == OperandLocation::REG) {
+            if (loc->reg != srcReg) out.emplace_back(MachineInstr::MV, MachineOperand::r(loc->reg), MachineOperand::r(srcReg));
+        }
+        else {
+            out.emplace_back(MachineInstr::SW, MachineOperand::r(srcReg), MachineOperand::mem(loc->offset, SP));
+        }
+    }
+}
+
+int RegisterAllocatorBase::getTotalStackSize() const {
+    return m_total_stack_size;
+}
+
+PhysReg RegisterAllocatorBase::getRegister(const Operand& op) const {
+    const OperandLocation* loc = locationOf(op);
+    if (loc && loc->kind == OperandLocation::REG) return loc->reg;
+    return NO_REG;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "RegisterAllocator.hpp"
+#include "Liveness.hpp"
+
+// 把值放进物理寄存器的分配器的公共部分：
+// 活跃分析、栈帧布局（ra、用到的被调用者保存寄存器、溢出槽）、序言/尾声和装载/存储。
+// 子类只需实现 assignRegisters，为每个值填入寄存器（NO_REG 表示溢出到栈上）。
+// t0-t2 留给代码生成器做临时寄存器，a0-a7 用于传参。
+// 栈帧按 sp 寻址，不用帧指针，s0 当作普通的被调用者保存寄存器分配；
+// 只有调用了别的函数才保存 ra，什么都不用保存也没有溢出时整个栈帧省掉。
+class RegisterAllocatorBase : public RegisterAllocator {
+public:
+    void prepare(const FunctionIR& func, const std::unordered_set<ValueKey>& folded) override;
+    void emitPrologue(std::vector<MachineInstr>& out) override;
+    void emitEpilogue(std::vector<MachineInstr>& out) override;
+    void emitTeardown(std::vector<MachineInstr>& out) override;
+    void loadOperand(const Operand& op, PhysReg destReg, std::vector<MachineInstr>& out) override;
+    void storeOperand(const Operand& result, PhysReg srcReg, std::vector<MachineInstr>& out) override;
+    int getTotalStackSize() const override;
+    PhysReg getRegister(const Operand& op) const override;
+
+protected:
+    // 可分配的寄存器：调用者保存的只能给不跨调用的值用。
+    // 叶函数（没有调用和尾调用）里 a0-a7 除了传进来的参数之外都空着，也放进调用者保存的一组
+    const std::vector<PhysReg>& callerSavedRegs() const { return m_caller_saved; }
+    static const std::vector<PhysReg>& calleeSavedRegs();
+    static bool isCalleeSaved(PhysReg reg);
+
+    // 由子类实现：根据 m_liveness 填写 m_assigned，被吸收的值（isFolded）不参加分配
+    virtual void assignRegisters(const FunctionIR& func) = 0;
+
+    bool isFolded(int v) const { return v >= 0 && v < (int)m_folded.size() && m_folded[v]; }
+
+    Liveness m_liveness;
+    std::vector<PhysReg> m_assigned; // 按值下标索引，NO_REG 表示溢出
+    std::vector<bool> m_folded;      // 按值下标索引：从不写出的值，既没有寄存器也没有栈槽
+
+private:
+    void layoutFrame(const FunctionIR& func);
+    const OperandLocation* locationOf(const Operand& op) const;
+
+    std::vector<PhysReg> m_caller_saved;
+    bool m_saves_ra = false;
+    int m_ra_offset = 0;
+    std::vector<OperandLocation> m_locations; // 按值下标索引，栈上的偏移相对 sp
+    std::vector<PhysReg> m_used_callee_saved;
+    std::vector<int> m_callee_saved_offsets;
+
+    int m_total_stack_size = 0;
+    std::vector<MachineInstr> m_param_init_code;
+};
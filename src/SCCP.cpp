@@ -0,0 +1,327 @@
+#include "SCCP.hpp"
+#include "SSA.hpp"
+#include "CFG.hpp"
+#include <climits>
+#include <cstdint>
+#include <set>
+
+bool fold_binary(Instruction::OpCode op, int a, int b, int& result) {
+    // 加减乘在无符号数上做，避免有符号溢出的未定义行为
+    const uint32_t ua = (uint32_t)a, ub = (uint32_t)b;
+    switch (op) {
+    case Instruction::ADD: result = (int)(ua + ub); return true;
+    case Instruction::SUB: result = (int)(ua - ub); return true;
+    case Instruction::MUL: result = (int)(ua * ub); return true;
+    case Instruction::DIV:
+        if (b == 0 || (a == INT_MIN && b == -1)) return false;
+        result = a / b;
+        return true;
+    case Instruction::MOD:
+        if (b == 0 || (a == INT_MIN && b == -1)) return false;
+        result = a % b;
+        return true;
+    case Instruction::EQ:  result = a == b; return true;
+    case Instruction::NEQ: result = a != b; return true;
+    case Instruction::LT:  result = a < b;  return true;
+    case Instruction::GT:  result = a > b;  return true;
+    case Instruction::LE:  result = a <= b; return true;
+    case Instruction::GE:  result = a >= b; return true;
+    default: return false;
+    }
+}
+
+bool fold_unary(Instruction::OpCode op, int a, int& result) {
+    if (op == Instruction::NOT) {
+        result = !a;
+        return true;
+    }
+    return false;
+}
+
+namespace {
+
+// 格：TOP（还没有见到定值）> CONST（单个常量）> BOTTOM（不是常量）
+struct LatticeValue {
+    enum State { TOP, CONST, BOTTOM };
+    State state = TOP;
+    int value = 0;
+
+    static LatticeValue constant(int v) { return { CONST, v }; }
+    static LatticeValue bottom() { return { BOTTOM, 0 }; }
+};
+
+class SCCPSolver {
+public:
+    explicit SCCPSolver(FunctionIR& func) : m_func(func) {}
+    bool run();
+
+private:
+    void solve();
+    void markEdge(int from, int to);
+    void visitInstr(int b, int i);
+    void visitBranch(int b);
+    LatticeValue evaluate(const Instruction& instr) const;
+    LatticeValue valueOf(const Operand& op) const;
+    void update(const Operand& def, LatticeValue v);
+    bool rewrite();
+
+    FunctionIR& m_func;
+    DefUseChains m_du;
+    std::vector<LatticeValue> m_lattice;
+    std::vector<bool> m_exec_block;
+    std::set<std::pair<int, int>> m_exec_edges;
+    std::vector<std::pair<int, int>> m_flow_work;
+    std::vector<int> m_ssa_work;
+};
+
+bool SCCPSolver::run() {
+    if (m_func.blocks.empty()) return false;
+    m_du.compute(m_func);
+    const int nv = m_du.numValues();
+    m_lattice.assign(nv, LatticeValue());
+    // 参数和没有定值点的值（未初始化的读）都不是常量
+    for (int v = 0; v < nv; ++v) {
+        if (m_du.def(v).block < 0) m_lattice[v] = LatticeValue::bottom();
+    }
+    m_exec_block.assign(m_func.blocks.size(), false);
+    solve();
+    return rewrite();
+}
+
+void SCCPSolver::solve() {
+    m_flow_work.push_back({ -1, 0 });
+    while (!m_flow_work.empty() || !m_ssa_work.empty()) {
+        while (!m_flow_work.empty()) {
+            auto edge = m_flow_work.back();
+            m_flow_work.pop_back();
+            const int b = edge.second;
+            const auto& instrs = m_func.blocks[b].instructions;
+            if (m_exec_block[b]) {
+                // 块已经访问过，新的入边只影响 PHI
+                for (int i = 0; i < (int)instrs.size() && instrs[i].opcode == Instruction::PHI; ++i) {
+                    visitInstr(b, i);
+                }
+                continue;
+            }
+            m_exec_block[b] = true;
+            for (int i = 0; i < (int)instrs.size(); ++i) visitInstr(b, i);
+            visitBranch(b);
+        }
+        while (!m_ssa_work.empty()) {
+            int v = m_ssa_work.back();
+            m_ssa_work.pop_back();
+            for (const InstrRef& use : m_du.uses(v)) {
+                if (!m_exec_block[use.block]) continue;
+                visitInstr(use.block, use.index);
+                const auto& instrs = m_func.blocks[use.block].instructions;
+                if (use.index == (int)instrs.size() - 1) visitBranch(use.block);
+            }
+        }
+    }
+}
+
+void SCCPSolver::markEdge(int from, int to) {
+    if (m_exec_edges.insert({ from, to }).second) {
+        m_flow_work.push_back({ from, to });
+    }
+}
+
+// 根据块末尾的跳转决定哪些出边可执行（块已是规范形式：跳转只在末尾）
+void SCCPSolver::visitBranch(int b) {
+    const auto& instrs = m_func.blocks[b].instructions;
+    const int fallthrough = b + 1 < (int)m_func.blocks.size() ? b + 1 : -1;
+    if (instrs.empty()) {
+        if (fallthrough >= 0) markEdge(b, fallthrough);
+        return;
+    }
+    const Instruction& last = instrs.back();
+    switch (last.opcode) {
+    case Instruction::RET: case Instruction::TAIL_CALL:
+        return;
+    case Instruction::JUMP: {
+        int t = find_block(m_func, last.arg1.name);
+        if (t >= 0) markEdge(b, t);
+        return;
+    }
+    case Instruction::JUMP_IF_ZERO: case Instruction::JUMP_IF_NZERO: {
+        LatticeValue cond = valueOf(last.arg1);
+        if (cond.state == LatticeValue::TOP) return;
+        int t = find_block(m_func, last.arg2.name);
+        bool may_jump = true, may_fall = true;
+        if (cond.state == LatticeValue::CONST) {
+            bool jumps = (last.opcode == Instruction::JUMP_IF_ZERO) == (cond.value == 0);
+            may_jump = jumps;
+            may_fall = !jumps;
+        }
+        if (may_jump && t >= 0) markEdge(b, t);
+        if (may_fall && fallthrough >= 0) markEdge(b, fallthrough);
+        return;
+    }
+    default:
+        if (fallthrough >= 0) markEdge(b, fallthrough);
+        return;
+    }
+}
+
+LatticeValue SCCPSolver::valueOf(const Operand& op) const {
+    if (op.kind == Operand::CONST) return LatticeValue::constant(op.value);
+    int v = m_du.indexOf(op);
+    if (v < 0) return LatticeValue(); // NONE：未定义
+    return m_lattice[v];
+}
+
+void SCCPSolver::update(const Operand& def, LatticeValue v) {
+    int idx = m_du.indexOf(def);
+    LatticeValue& cur = m_lattice[idx];
+    // 只能沿格向下走
+    if (cur.state == LatticeValue::BOTTOM) return;
+    if (cur.state == LatticeValue::CONST) {
+        if (v.state == LatticeValue::TOP) return;
+        if (v.state == LatticeValue::CONST && v.value == cur.value) return;
+        v = LatticeValue::bottom();
+    }
+    else if (v.state == LatticeValue::TOP) {
+        return;
+    }
+    cur = v;
+    m_ssa_work.push_back(idx);
+}
+
+LatticeValue SCCPSolver::evaluate(const Instruction& instr) const {
+    switch (instr.opcode) {
+    case Instruction::ASSIGN:
+        return valueOf(instr.arg1);
+    case Instruction::NOT: {
+        LatticeValue a = valueOf(instr.arg1);
+        if (a.state != LatticeValue::CONST) return a;
+        int r;
+        return fold_unary(instr.opcode, a.value, r) ? LatticeValue::constant(r) : LatticeValue::bottom();
+    }
+    case Instruction::ADD: case Instruction::SUB: case Instruction::MUL: case Instruction::DIV: case Instruction::MOD:
+    case Instruction::EQ: case Instruction::NEQ: case Instruction::LT: case Instruction::GT: case Instruction::LE: case Instruction::GE: {
+        LatticeValue a = valueOf(instr.arg1), b = valueOf(instr.arg2);
+        if (a.state == LatticeValue::BOTTOM || b.state == LatticeValue::BOTTOM) return LatticeValue::bottom();
+        if (a.state == LatticeValue::TOP || b.state == LatticeValue::TOP) return LatticeValue();
+        int r;
+        return fold_binary(instr.opcode, a.value, b.value, r) ? LatticeValue::constant(r) : LatticeValue::bottom();
+    }
+    default:
+        return LatticeValue::bottom(); // CALL 等
+    }
+}
+
+void SCCPSolver::visitInstr(int b, int i) {
+    const Instruction& instr = m_func.blocks[b].instructions[i];
+    const Operand* def = instr_def(instr);
+    if (!def) return;
+
+    if (instr.opcode != Instruction::PHI) {
+        update(*def, evaluate(instr));
+        return;
+    }
+    // PHI：合并所有可执行入边上的值
+    LatticeValue result;
+    for (const auto& arg : instr.phi_args) {
+        int p = find_block(m_func, arg.block);
+        if (p < 0 || !m_exec_edges.count({ p, b })) continue;
+        // 某条路径上未定义的变量不当作常量，免得条件跳转停在 TOP 上
+        LatticeValue v = arg.value.kind == Operand::NONE ? LatticeValue::bottom() : valueOf(arg.value);
+        if (v.state == LatticeValue::TOP) continue;
+        if (v.state == LatticeValue::BOTTOM ||
+            (result.state == LatticeValue::CONST && result.value != v.value)) {
+            result = LatticeValue::bottom();
+            break;
+        }
+        result = v;
+    }
+    update(*def, result);
+}
+
+bool SCCPSolver::rewrite() {
+    bool changed = false;
+    const int n = (int)m_func.blocks.size();
+
+    auto to_const = [&](Operand& op) {
+        int v = m_du.indexOf(op);
+        if (v < 0 || m_lattice[v].state != LatticeValue::CONST) return;
+        int value = m_lattice[v].value;
+        op = Operand();
+        op.kind = Operand::CONST;
+        op.value = value;
+        changed = true;
+    };
+
+    for (int b = 0; b < n; ++b) {
+        if (!m_exec_block[b]) continue;
+        auto& instrs = m_func.blocks[b].instructions;
+        std::vector<Instruction> kept;
+        kept.reserve(instrs.size());
+        for (auto& instr : instrs) {
+            const Operand* def = instr_def(instr);
+            if (def && instr.opcode != Instruction::CALL) {
+                int v = m_du.indexOf(*def);
+                if (m_lattice[v].state == LatticeValue::CONST) {
+                    changed = true; // 所有使用点都会换成常量
+                    continue;
+                }
+            }
+            if (instr.opcode == Instruction::PHI) {
+                // 只保留可执行入边上的实参
+                auto& args = instr.phi_args;
+                for (size_t k = 0; k < args.size();) {
+                    int p = find_block(m_func, args[k].block);
+                    if (p < 0 || !m_exec_edges.count({ p, b })) {
+                        args.erase(args.begin() + k);
+                        changed = true;
+                    }
+                    else {
+                        ++k;
+                    }
+                }
+            }
+            for_each_use(instr, to_const);
+
+            if ((instr.opcode == Instruction::JUMP_IF_ZERO || instr.opcode == Instruction::JUMP_IF_NZERO) &&
+                instr.arg1.kind == Operand::CONST) {
+                bool jumps = (instr.opcode == Instruction::JUMP_IF_ZERO) == (instr.arg1.value == 0);
+                changed = true;
+                if (!jumps) continue;
+                Instruction jump;
+                jump.opcode = Instruction::JUMP;
+                jump.arg1.kind = Operand::LABEL;
+                jump.arg1.name = instr.arg2.name;
+                kept.push_back(jump);
+                continue;
+            }
+            kept.push_back(std::move(instr));
+        }
+        instrs = std::move(kept);
+    }
+
+    // 删除不可执行的块；可执行块的落入边一定也可执行，所以布局上的落入关系不受影响
+    std::vector<BasicBlock> blocks;
+    blocks.reserve(n);
+    for (int b = 0; b < n; ++b) {
+        if (m_exec_block[b]) blocks.push_back(std::move(m_func.blocks[b]));
+        else changed = true;
+    }
+    // 删块之后条件跳转的目标可能正好是下一块
+    for (size_t b = 0; b + 1 < blocks.size(); ++b) {
+        auto& instrs = blocks[b].instructions;
+        if (!instrs.empty() && jump_target(instrs.back()) && instrs.back().opcode != Instruction::JUMP &&
+            instrs.back().arg2.name == blocks[b + 1].label) {
+            instrs.pop_back();
+        }
+    }
+    m_func.blocks = std::move(blocks);
+    if (changed) build_cfg(m_func);
+    return changed;
+}
+
+} // namespace
+
+bool SCCPPass::runOnFunction(FunctionIR& func) {
+    if (!func.in_ssa) return false;
+    SCCPSolver solver(func);
+    return solver.run();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+// 对两个常量做二元运算，结果按 32 位补码回绕。
+// 除以 0 和 INT_MIN / -1 不折叠（保留运行时行为），此时返回 false。
+bool fold_binary(Instruction::OpCode op, int a, int b, int& result);
+
+// 一元运算（目前只有 NOT）
+bool fold_unary(Instruction::OpCode op, int a, int& result);
+
+/**
+ * @class SCCPPass
+ * @brief 稀疏条件常量传播（Wegman & Zadeck）
+ *
+ * 在 SSA 形式上同时求值的格（未定/常量/变量）和边的可执行性：
+ * 只沿可执行的边传播常量，PHI 只合并来自可执行边的实参。
+ * 结束后把常量值代入所有使用点、删掉定值为常量的指令、
+ * 把条件已知的 JUMP_IF_ZERO/JUMP_IF_NZERO 换成 JUMP 或删掉，并删除不可执行的块。
+ */
+class SCCPPass : public FunctionPass {
+public:
+    const char* name() const override { return "sccp"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
@@ -0,0 +1,500 @@
+#include "SSA.hpp"
+#include "CFG.hpp"
+#include "Liveness.hpp"
+#include <algorithm>
+#include <map>
+#include <functional>
+
+namespace {
+
+// 重命名过程中的状态
+class SSABuilder {
+public:
+    explicit SSABuilder(FunctionIR& func) : m_func(func) {}
+    void run();
+
+private:
+    void placePhis();
+    void rename();
+    void renameBlock(int b, std::vector<std::vector<Operand>*>& pushed);
+    Operand newVersion(const Operand& orig);
+
+    FunctionIR& m_func;
+    std::unordered_map<ValueKey, std::vector<Operand>> m_stacks; // 变量 -> 当前可见的版本
+    std::unordered_map<Symbol, int> m_versions;                  // VAR 的下一个版本号
+    std::unordered_map<ValueKey, bool> m_temp_seen;              // TEMP 是否已经定值过
+    std::vector<std::vector<ValueKey>> m_phi_keys;               // 每个块开头的 PHI 对应的原变量
+};
+
+void SSABuilder::run() {
+    canonicalize_blocks(m_func);
+    if (m_func.blocks.empty()) return;
+
+    placePhis();
+
+    // 参数在入口处的值就是原来的名字
+    for (const auto& param : m_func.params) {
+        Operand op;
+        op.kind = Operand::VAR;
+        op.name = param.name;
+        m_stacks[value_key(op)].push_back(op);
+    }
+    rename();
+}
+
+void SSABuilder::placePhis() {
+    const int n = (int)m_func.blocks.size();
+    Liveness liveness;
+    liveness.compute(m_func);
+
+    // 每个变量的定值块；参数视为在入口处定值
+    std::map<ValueKey, std::vector<int>> defsites; // 有序，使 PHI 的顺序稳定
+    std::unordered_map<ValueKey, Operand> originals;
+    for (const auto& param : m_func.params) {
+        Operand op;
+        op.kind = Operand::VAR;
+        op.name = param.name;
+        defsites[value_key(op)].push_back(0);
+        originals[value_key(op)] = op;
+    }
+    for (int b : m_func.cfg.rpo) {
+        for (const auto& instr : m_func.blocks[b].instructions) {
+            const Operand* def = instr_def(instr);
+            if (!def) continue;
+            const ValueKey key = Liveness::keyOf(*def);
+            auto& sites = defsites[key];
+            if (sites.empty() || sites.back() != b) sites.push_back(b);
+            originals.emplace(key, *def);
+        }
+    }
+
+    const auto df = dominance_frontiers(m_func);
+    std::vector<std::vector<Instruction>> phis(n);
+    m_phi_keys.assign(n, {});
+    std::vector<int> has_phi(n, -1), in_work(n, -1);
+    int var_id = 0;
+    for (auto& entry : defsites) {
+        const ValueKey key = entry.first;
+        const Operand& orig = originals[key];
+        const int idx = liveness.indexOf(orig);
+        std::vector<int> work = entry.second;
+        for (int b : work) in_work[b] = var_id;
+        while (!work.empty()) {
+            int x = work.back();
+            work.pop_back();
+            for (int y : df[x]) {
+                if (has_phi[y] == var_id) continue;
+                has_phi[y] = var_id;
+                if (idx < 0 || !liveness.liveIn(y)[idx]) continue; // 剪枝：汇合点不活跃就不需要 PHI
+
+                Instruction phi;
+                phi.opcode = Instruction::PHI;
+                phi.result = orig;
+                for (int p : m_func.blocks[y].preds) {
+                    if (!is_reachable(m_func, p)) continue;
+                    phi.phi_args.push_back({ m_func.blocks[p].label, Operand() });
+                }
+                phis[y].push_back(std::move(phi));
+                m_phi_keys[y].push_back(key);
+                if (in_work[y] != var_id) {
+                    in_work[y] = var_id;
+                    work.push_back(y);
+                }
+            }
+        }
+        ++var_id;
+    }
+
+    for (int b = 0; b < n; ++b) {
+        if (phis[b].empty()) continue;
+        auto& instrs = m_func.blocks[b].instructions;
+        instrs.insert(instrs.begin(), phis[b].begin(), phis[b].end());
+    }
+}
+
+Operand SSABuilder::newVersion(const Operand& orig) {
+    if (orig.kind == Operand::VAR) {
+        Operand op = orig;
+        op.name = Symbol::intern(orig.name + "." + std::to_string(++m_versions[orig.name]));
+        return op;
+    }
+    bool& seen = m_temp_seen[Liveness::keyOf(orig)];
+    if (!seen) {
+        seen = true;
+        return orig;
+    }
+    return make_temp(m_func);
+}
+
+// 沿支配树先序遍历重命名。用显式栈而不是递归：支配树的深度可以和块数一样大
+// （一长串顺序的 if），递归会把调用栈用完。
+// pushed 记录压过版本的栈，每一帧记住进入时 pushed 的长度，离开时弹回去
+void SSABuilder::rename() {
+    struct Frame {
+        int block;
+        size_t next_child;
+        size_t pushed_begin;
+    };
+    std::vector<std::vector<Operand>*> pushed;
+    std::vector<Frame> stack;
+    renameBlock(0, pushed);
+    stack.push_back({ 0, 0, 0 });
+    while (!stack.empty()) {
+        Frame& top = stack.back();
+        const auto& children = m_func.cfg.dom_children[top.block];
+        if (top.next_child < children.size()) {
+            const int c = children[top.next_child++];
+            const size_t begin = pushed.size();
+            renameBlock(c, pushed);
+            stack.push_back({ c, 0, begin });
+            continue;
+        }
+        while (pushed.size() > top.pushed_begin) {
+            pushed.back()->pop_back();
+            pushed.pop_back();
+        }
+        stack.pop_back();
+    }
+}
+
+// 重命名块 b 自己的指令，并填写后继块中 PHI 来自本块的实参
+void SSABuilder::renameBlock(int b, std::vector<std::vector<Operand>*>& pushed) {
+    BasicBlock& bb = m_func.blocks[b];
+
+    for (auto& instr : bb.instructions) {
+        if (instr.opcode != Instruction::PHI) {
+            for_each_use(instr, [&](Operand& op) {
+                auto it = m_stacks.find(Liveness::keyOf(op));
+                if (it != m_stacks.end() && !it->second.empty()) op = it->second.back();
+                // 否则是未定义的读，保留原来的名字
+            });
+        }
+        if (Operand* def = instr_def(instr)) {
+            std::vector<Operand>& versions = m_stacks[Liveness::keyOf(*def)];
+            *def = newVersion(*def);
+            versions.push_back(*def);
+            pushed.push_back(&versions);
+        }
+    }
+
+    for (int s : bb.succs) {
+        const auto& keys = m_phi_keys[s];
+        for (size_t j = 0; j < keys.size(); ++j) {
+            Instruction& phi = m_func.blocks[s].instructions[j];
+            for (auto& arg : phi.phi_args) {
+                if (arg.block != bb.label) continue;
+                auto it = m_stacks.find(keys[j]);
+                arg.value = (it != m_stacks.end() && !it->second.empty()) ? it->second.back() : Operand();
+            }
+        }
+    }
+}
+
+// 把一组并行复制 dest_i = src_i 排成顺序执行的 ASSIGN。
+// 先发出目标不再被其他复制读取的那些；剩下的全是环，借一个临时变量断开。
+std::vector<Instruction> sequentialize(FunctionIR& func, std::vector<std::pair<Operand, Operand>> copies) {
+    std::vector<Instruction> out;
+    copies.erase(std::remove_if(copies.begin(), copies.end(), [](const std::pair<Operand, Operand>& c) {
+        return c.second.kind == Operand::NONE || same_value(c.first, c.second);
+    }), copies.end());
+
+    auto emit = [&](const Operand& dest, const Operand& src) {
+        Instruction instr;
+        instr.opcode = Instruction::ASSIGN;
+        instr.result = dest;
+        instr.arg1 = src;
+        out.push_back(instr);
+    };
+
+    while (!copies.empty()) {
+        bool progress = false;
+        for (size_t i = 0; i < copies.size(); ++i) {
+            bool blocked = false;
+            for (size_t j = 0; j < copies.size(); ++j) {
+                if (j != i && same_value(copies[j].second, copies[i].first)) blocked = true;
+            }
+            if (!blocked) {
+                emit(copies[i].first, copies[i].second);
+                copies.erase(copies.begin() + i);
+                progress = true;
+                break;
+            }
+        }
+        if (!progress) {
+            Operand saved = copies[0].first;
+            Operand tmp = make_temp(func);
+            emit(tmp, saved);
+            for (auto& c : copies) {
+                if (same_value(c.second, saved)) c.second = tmp;
+            }
+        }
+    }
+    return out;
+}
+
+// 合并不冲突的复制两端（激进合并）。
+// 消去 PHI 产生的复制在没有被优化打乱的地方都可以这样消掉，
+// 否则线性扫描这类不做合并的分配器会为每个版本各占一个位置。
+// 只有出现在复制两端的值（候选）才可能合并，冲突也只在候选之间记录：
+// 定值点与其后活跃的候选冲突，复制的源除外。
+void coalesce_copies(FunctionIR& func) {
+    Liveness liveness;
+    liveness.compute(func);
+    const int nv = liveness.numValues();
+    if (nv == 0) return;
+
+    // 候选编号：值下标 -> 候选，members 反过来
+    std::vector<int> cand(nv, -1);
+    std::vector<int> members;
+    auto add_candidate = [&](int v) {
+        if (cand[v] < 0) {
+            cand[v] = (int)members.size();
+            members.push_back(v);
+        }
+    };
+    std::vector<std::pair<int, int>> copies;
+    for (const auto& bb : func.blocks) {
+        for (const auto& instr : bb.instructions) {
+            if (instr.opcode != Instruction::ASSIGN) continue;
+            const int x = liveness.indexOf(instr.result), y = liveness.indexOf(instr.arg1);
+            if (x < 0 || y < 0 || x == y) continue;
+            add_candidate(x);
+            add_candidate(y);
+            copies.push_back({ x, y });
+        }
+    }
+    if (copies.empty()) return;
+    const int nc = (int)members.size();
+
+    // 冲突边（候选编号），每个候选一张邻接表
+    std::vector<std::vector<int>> adj(nc);
+    for (int b = 0; b < liveness.numBlocks(); ++b) {
+        if (!is_reachable(func, b)) continue;
+        const auto& instrs = func.blocks[b].instructions;
+        liveness.walkBlockBackward(func, b, [&](int i, const LiveSet& live) {
+            const Operand* def = instr_def(instrs[i]);
+            if (!def) return;
+            const int d = cand[liveness.indexOf(*def)];
+            if (d < 0) return;
+            const int src = instrs[i].opcode == Instruction::ASSIGN ? liveness.indexOf(instrs[i].arg1) : -1;
+            live.forEach([&](int v) {
+                const int c = cand[v];
+                if (c < 0 || c == d || v == src) return;
+                adj[d].push_back(c);
+                adj[c].push_back(d);
+            });
+        });
+    }
+    for (auto& list : adj) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    // 候选上的并查集；代表元优先取参数（参数靠名字接收实参），其次取 VAR。
+    // 参数在入口处同时定值，两个都含参数的类不能合并。
+    // 类的邻接表挂在代表元上，合并时把小的并进大的；两类是否冲突看较小一方的邻居里有没有另一类的成员
+    const int np = (int)func.params.size();
+    std::vector<int> parent(nc);
+    for (int c = 0; c < nc; ++c) parent[c] = c;
+    auto find = [&](int c) {
+        int root = c;
+        while (parent[root] != root) root = parent[root];
+        while (parent[c] != root) {
+            const int next = parent[c];
+            parent[c] = root;
+            c = next;
+        }
+        return root;
+    };
+    auto rank = [&](int c) { return members[c] < np ? 2 : (liveness.valueAt(members[c]).kind == Operand::VAR ? 1 : 0); };
+    auto interferes = [&](int x, int y) {
+        const int from = adj[x].size() <= adj[y].size() ? x : y;
+        const int other = from == x ? y : x;
+        for (int c : adj[from]) {
+            if (find(c) == other) return true;
+        }
+        return false;
+    };
+
+    bool merged = false;
+    for (const auto& copy : copies) {
+        int x = find(cand[copy.first]), y = find(cand[copy.second]);
+        if (x == y || (members[x] < np && members[y] < np) || interferes(x, y)) continue;
+        if (rank(y) > rank(x)) std::swap(x, y);
+        parent[y] = x;
+        if (adj[x].size() < adj[y].size()) adj[x].swap(adj[y]);
+        adj[x].insert(adj[x].end(), adj[y].begin(), adj[y].end());
+        std::vector<int>().swap(adj[y]);
+        merged = true;
+    }
+    if (!merged) return;
+
+    for (auto& bb : func.blocks) {
+        for (auto& instr : bb.instructions) {
+            auto rewrite = [&](Operand& op) {
+                const int v = liveness.indexOf(op);
+                if (v >= 0 && cand[v] >= 0) op = liveness.valueAt(members[find(cand[v])]);
+            };
+            for_each_use(instr, rewrite);
+            if (Operand* def = instr_def(instr)) rewrite(*def);
+        }
+        bb.instructions.erase(std::remove_if(bb.instructions.begin(), bb.instructions.end(), [](const Instruction& instr) {
+            return instr.opcode == Instruction::ASSIGN && same_value(instr.result, instr.arg1);
+        }), bb.instructions.end());
+    }
+}
+
+} // namespace
+
+void construct_ssa(FunctionIR& func) {
+    if (func.in_ssa) return;
+    SSABuilder builder(func);
+    builder.run();
+    func.in_ssa = true;
+}
+
+void destruct_ssa(FunctionIR& func) {
+    if (!func.in_ssa) return;
+    const int n = (int)func.blocks.size();
+
+    // 1. 收集每条边上的并行复制并删掉 PHI
+    std::map<std::pair<int, int>, std::vector<std::pair<Operand, Operand>>> edge_copies;
+    for (int s = 0; s < n; ++s) {
+        auto& instrs = func.blocks[s].instructions;
+        auto first_non_phi = instrs.begin();
+        for (; first_non_phi != instrs.end() && first_non_phi->opcode == Instruction::PHI; ++first_non_phi) {
+            for (const auto& arg : first_non_phi->phi_args) {
+                int p = find_block(func, arg.block);
+                if (p < 0 || !is_reachable(func, p)) continue;
+                edge_copies[{ p, s }].push_back({ first_non_phi->result, arg.value });
+            }
+        }
+        instrs.erase(instrs.begin(), first_non_phi);
+    }
+
+    // 2. 把复制放到边上
+    std::vector<std::vector<BasicBlock>> insert_after(n); // 落入边拆出的块紧跟在前驱之后
+    std::vector<BasicBlock> appended;                     // 跳转边拆出的块放在函数末尾
+    for (auto& entry : edge_copies) {
+        const int p = entry.first.first, s = entry.first.second;
+        std::vector<Instruction> seq = sequentialize(func, entry.second);
+        if (seq.empty()) continue;
+        auto& instrs = func.blocks[p].instructions;
+
+        if (func.blocks[p].succs.size() == 1) {
+            // 复制放在末尾的跳转之前
+            auto pos = instrs.end();
+            if (!instrs.empty() && jump_target(instrs.back())) {
+                pos = instrs.end() - 1;
+                // 条件跳转读的值可能被复制改写，先存起来
+                Operand& cond = instrs.back().arg1;
+                if (instrs.back().opcode != Instruction::JUMP && is_value(cond)) {
+                    for (const auto& copy : seq) {
+                        if (!same_value(copy.result, cond)) continue;
+                        Instruction save;
+                        save.opcode = Instruction::ASSIGN;
+                        save.result = make_temp(func);
+                        save.arg1 = cond;
+                        cond = save.result;
+                        seq.insert(seq.begin(), save);
+                        break;
+                    }
+                }
+            }
+            instrs.insert(pos, seq.begin(), seq.end());
+            continue;
+        }
+
+        // 关键边：拆出一个只做复制的新块
+        BasicBlock edge;
+        edge.label = new_block_label(func, "edge");
+        edge.instructions = std::move(seq);
+        Instruction& last = instrs.back();
+        if (jump_target(last) && *jump_target(last) == func.blocks[s].label) {
+            last.arg2.name = edge.label;
+            Instruction jump;
+            jump.opcode = Instruction::JUMP;
+            jump.arg1.kind = Operand::LABEL;
+            jump.arg1.name = func.blocks[s].label;
+            edge.instructions.push_back(jump);
+            appended.push_back(std::move(edge));
+        }
+        else {
+            insert_after[p].push_back(std::move(edge));
+        }
+    }
+
+    std::vector<BasicBlock> blocks;
+    blocks.reserve(n + appended.size());
+    for (int b = 0; b < n; ++b) {
+        blocks.push_back(std::move(func.blocks[b]));
+        for (auto& edge : insert_after[b]) blocks.push_back(std::move(edge));
+    }
+    for (auto& edge : appended) blocks.push_back(std::move(edge));
+    func.blocks = std::move(blocks);
+
+    func.in_ssa = false;
+    build_cfg(func);
+
+    // 3. 消掉能合并的复制
+    coalesce_copies(func);
+}
+
+// --- DefUseChains ---
+
+int DefUseChains::indexOf(const Operand& op) const {
+    if (!is_value(op)) return -1;
+    auto it = m_index.find(Liveness::keyOf(op));
+    return it == m_index.end() ? -1 : it->second;
+}
+
+int DefUseChains::addValue(const Operand& op) {
+    const ValueKey key = Liveness::keyOf(op);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) return it->second;
+    int v = (int)m_values.size();
+    m_index.emplace(key, v);
+    m_values.push_back(op);
+    m_defs.emplace_back();
+    m_uses.emplace_back();
+    return v;
+}
+
+void DefUseChains::compute(const FunctionIR& func) {
+    m_index.clear();
+    m_values.clear();
+    m_defs.clear();
+    m_uses.clear();
+    for (const auto& param : func.params) {
+        Operand op;
+        op.kind = Operand::VAR;
+        op.name = param.name;
+        addValue(op);
+    }
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        const auto& instrs = func.blocks[b].instructions;
+        for (int i = 0; i < (int)instrs.size(); ++i) {
+            const InstrRef ref{ b, i };
+            for_each_use(instrs[i], [&](const Operand& op) {
+                m_uses[addValue(op)].push_back(ref);
+            });
+            if (const Operand* def = instr_def(instrs[i])) {
+                m_defs[addValue(*def)] = ref;
+            }
+        }
+    }
+}
+
+// --- 遍 ---
+
+bool SSAConstructionPass::runOnFunction(FunctionIR& func) {
+    if (func.in_ssa) return false;
+    construct_ssa(func);
+    return true;
+}
+
+bool SSADestructionPass::runOnFunction(FunctionIR& func) {
+    if (!func.in_ssa) return false;
+    destruct_ssa(func);
+    return true;
+}
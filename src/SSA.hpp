@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// --- SSA 构造与消去 ---
+// construct_ssa 先把函数整理成规范形式（见 canonicalize_blocks），
+// 再按支配边界放置剪枝的 PHI（只放在变量活跃的汇合点），沿支配树重命名：
+// VAR x 的每次定值变成 x.1、x.2 ……，TEMP 的第一次定值保留原编号、之后的定值换成新的临时变量。
+// 参数在入口处的值仍然用原来的名字。
+void construct_ssa(FunctionIR& func);
+
+// 把每条入边上的 PHI 变成前驱末尾的并行复制并顺序化；
+// 前驱有多个后继时（关键边）拆出一个新块来放这些复制。
+// 最后把互不冲突的复制两端合并成同一个名字，删掉多余的复制。
+void destruct_ssa(FunctionIR& func);
+
+// 指令的位置：块 id 与块内下标
+struct InstrRef {
+    int block = -1;
+    int index = -1;
+};
+
+// SSA 形式下的稀疏 def-use 链：每个值只有一个定值点，并记下它的所有使用点。
+// 只在 IR 未被修改时有效；修改之后需要重新 compute。
+class DefUseChains {
+public:
+    void compute(const FunctionIR& func);
+
+    int numValues() const { return (int)m_values.size(); }
+    int indexOf(const Operand& op) const; // 不是 VAR/TEMP 时返回 -1
+    const Operand& valueAt(int v) const { return m_values[v]; }
+
+    // 定值点；参数（以及未定义的值）的 block 为 -1
+    const InstrRef& def(int v) const { return m_defs[v]; }
+    // 使用点，PHI 的使用记在 PHI 所在的位置
+    const std::vector<InstrRef>& uses(int v) const { return m_uses[v]; }
+
+private:
+    int addValue(const Operand& op);
+
+    std::unordered_map<ValueKey, int> m_index;
+    std::vector<Operand> m_values;
+    std::vector<InstrRef> m_defs;
+    std::vector<std::vector<InstrRef>> m_uses;
+};
+
+// 进入 SSA：之后的遍可以依赖 func.in_ssa 和 DefUseChains
+class SSAConstructionPass : public FunctionPass {
+public:
+    const char* name() const override { return "ssa"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
+
+// 离开 SSA：必须在代码生成之前运行
+class SSADestructionPass : public FunctionPass {
+public:
+    const char* name() const override { return "out-of-ssa"; }
+    bool runOnFunction(FunctionIR& func) override;
+};
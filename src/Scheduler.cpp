@@ -0,0 +1,391 @@
+#include "Scheduler.hpp"
+#include "Liveness.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+using Graph = InstructionScheduler::Graph;
+using MI = MachineInstr;
+
+// 按给定顺序发射时区域需要的周期数（最后一条指令发射之后为止）
+long simulate(const Graph& g, const std::vector<int>& order) {
+    const int n = g.size();
+    std::vector<long> earliest(n, 0);
+    long cycle = 0;
+    for (int v : order) {
+        cycle = std::max(cycle, earliest[v]);
+        for (const auto& e : g.succs[v]) earliest[e.to] = std::max(earliest[e.to], cycle + e.latency);
+        ++cycle;
+    }
+    return cycle;
+}
+
+// 按顺序发射时同时活跃的值的个数（只在分配之前跟踪）
+struct PressureTracker {
+    const Graph& g;
+    std::vector<int> remaining; // 每个值在区域里还没发射的读
+    int live = 0;
+
+    explicit PressureTracker(const Graph& graph) : g(graph), remaining(graph.live_out.size(), 0) {
+        for (const auto& r : g.reads) {
+            for (int v : r) remaining[v]++;
+        }
+        for (char in : g.live_in) live += in;
+    }
+    // 发射 node 之后活跃值个数的变化：读完最后一次的值死掉，写出的值（之后还要用）开始活跃
+    int delta(int node) const {
+        int d = 0;
+        for (int v : g.reads[node]) {
+            if (remaining[v] == 1 && !g.live_out[v]) --d;
+        }
+        for (int v : g.writes[node]) {
+            if (remaining[v] > 0 || g.live_out[v]) ++d;
+        }
+        return d;
+    }
+    void issue(int node) {
+        live += delta(node);
+        for (int v : g.reads[node]) remaining[v]--;
+    }
+};
+
+int peak_pressure(const Graph& g, const std::vector<int>& order) {
+    PressureTracker tracker(g);
+    int peak = tracker.live;
+    for (int v : order) {
+        tracker.issue(v);
+        peak = std::max(peak, tracker.live);
+    }
+    return peak;
+}
+
+// 寄存器分配之前参与调度的 IR 指令：没有副作用、只读写操作数
+bool is_schedulable(const Instruction& instr) {
+    switch (instr.opcode) {
+    case Instruction::ADD: case Instruction::SUB: case Instruction::MUL: case Instruction::DIV: case Instruction::MOD:
+    case Instruction::NOT: case Instruction::EQ: case Instruction::NEQ: case Instruction::LT: case Instruction::GT:
+    case Instruction::LE: case Instruction::GE: case Instruction::ASSIGN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool is_memory(const MachineInstr& mi) {
+    return mi.opcode == MI::LW || mi.opcode == MI::SW;
+}
+
+// 两条访存指令可能访问同一个字：基址寄存器不同时无法判断
+bool may_alias(const MachineInstr& a, const MachineInstr& b) {
+    const MachineOperand& ma = a.ops[1];
+    const MachineOperand& mb = b.ops[1];
+    if (ma.reg != mb.reg) return true;
+    return std::abs(ma.value - mb.value) < 4;
+}
+
+} // namespace
+
+bool SchedModel::parse(std::istream& in, std::string& error) {
+    std::string line;
+    for (int line_no = 1; std::getline(in, line); ++line_no) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key)) continue;
+        int value = 0;
+        std::string rest;
+        if (!(fields >> value) || (fields >> rest) || value < 1) {
+            error = "line " + std::to_string(line_no) + ": expected '<class> <latency>' with a positive latency";
+            return false;
+        }
+        if (key == "alu") alu = value;
+        else if (key == "load") load = value;
+        else if (key == "mul") mul = value;
+        else if (key == "div") div = value;
+        else {
+            error = "line " + std::to_string(line_no) + ": unknown instruction class '" + key + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SchedModel::loadFile(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open '" + path + "'";
+        return false;
+    }
+    if (!parse(in, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+int SchedModel::latency(MachineInstr::Opcode op) const {
+    switch (op) {
+    case MI::LW: return load;
+    case MI::MUL: case MI::MULH: return mul;
+    case MI::DIV: case MI::REM: return div;
+    default: return alu;
+    }
+}
+
+int SchedModel::latency(const Instruction& instr) const {
+    // 乘除常量会被代码生成器展开成移位/乘高位序列（见 StrengthReduction），按展开后的长度估计
+    switch (instr.opcode) {
+    case Instruction::MUL:
+        return instr.arg1.kind == Operand::CONST || instr.arg2.kind == Operand::CONST ? 2 * alu : mul;
+    case Instruction::DIV: case Instruction::MOD:
+        return instr.arg2.kind == Operand::CONST ? mul + 2 * alu : div;
+    default:
+        return alu;
+    }
+}
+
+std::vector<int> InstructionScheduler::schedule(const Graph& g, Phase phase) {
+    const int n = g.size();
+    std::vector<int> identity(n);
+    for (int i = 0; i < n; ++i) identity[i] = i;
+
+    // 关键路径长度：从这条指令发射到区域里所有依赖它的结果都就绪
+    std::vector<long> height(n);
+    std::vector<int> npreds(n, 0);
+    for (int i = n - 1; i >= 0; --i) {
+        height[i] = g.latency[i];
+        for (const auto& e : g.succs[i]) {
+            height[i] = std::max(height[i], e.latency + height[e.to]);
+            npreds[e.to]++;
+        }
+    }
+
+    std::vector<int> ready;
+    for (int i = 0; i < n; ++i) {
+        if (npreds[i] == 0) ready.push_back(i);
+    }
+    const bool pressure = g.tracksPressure();
+    const int limit = pressure ? peak_pressure(g, identity) : 0;
+    PressureTracker tracker(g);
+    auto blocked = [&](int v) { return pressure && tracker.live + tracker.delta(v) > limit; };
+
+    std::vector<long> earliest(n, 0);
+    std::vector<int> order;
+    long cycle = 0;
+    while (!ready.empty()) {
+        // 不会让压力超过原顺序峰值的优先；其次已就绪的优先；
+        // 都就绪时关键路径长的优先；都没就绪时最早就绪的优先
+        size_t best = 0;
+        for (size_t k = 1; k < ready.size(); ++k) {
+            const int v = ready[k], b = ready[best];
+            const bool v_blocked = blocked(v), b_blocked = blocked(b);
+            const bool v_avail = earliest[v] <= cycle, b_avail = earliest[b] <= cycle;
+            bool better;
+            if (v_blocked != b_blocked) better = !v_blocked;
+            else if (v_avail != b_avail) better = v_avail;
+            else if (!v_avail && earliest[v] != earliest[b]) better = earliest[v] < earliest[b];
+            else if (height[v] != height[b]) better = height[v] > height[b];
+            else better = v < b;
+            if (better) best = k;
+        }
+        const int v = ready[best];
+        ready[best] = ready.back();
+        ready.pop_back();
+
+        cycle = std::max(cycle, earliest[v]);
+        for (const auto& e : g.succs[v]) {
+            earliest[e.to] = std::max(earliest[e.to], cycle + e.latency);
+            if (--npreds[e.to] == 0) ready.push_back(e.to);
+        }
+        if (pressure) tracker.issue(v);
+        order.push_back(v);
+        ++cycle;
+    }
+
+    const long before = simulate(g, identity);
+    const long after = simulate(g, order);
+    PhaseStats& stats = m_stats[phase];
+    stats.regions++;
+    stats.cycles_before += before;
+    // 贪心的结果偶尔不如原顺序（或者压力还是超了），这时保持不动
+    if (after >= before || (pressure && peak_pressure(g, order) > limit)) {
+        stats.cycles_after += before;
+        return identity;
+    }
+    stats.cycles_after += after;
+    for (int i = 0; i < n; ++i) stats.moved += order[i] != i;
+    return order;
+}
+
+void InstructionScheduler::scheduleIR(FunctionIR& func) {
+    Liveness liveness;
+    liveness.compute(func);
+    for (int b = 0; b < (int)func.blocks.size(); ++b) {
+        auto& instrs = func.blocks[b].instructions;
+        // 先找出所有区域 [begin, end)，再在一趟反向遍历里只记下各区域出口处的活跃集合
+        std::vector<std::pair<size_t, size_t>> regions;
+        for (size_t i = 0; i < instrs.size();) {
+            if (!is_schedulable(instrs[i])) {
+                ++i;
+                continue;
+            }
+            size_t j = i;
+            while (j < instrs.size() && is_schedulable(instrs[j])) ++j;
+
+            // 留给指令选择合并的最后一条：给紧随的条件跳转用的比较、块末的常量赋值
+            size_t end = j;
+            const Instruction& last = instrs[j - 1];
+            const bool feeds_branch = j < instrs.size() &&
+                (instrs[j].opcode == Instruction::JUMP_IF_ZERO || instrs[j].opcode == Instruction::JUMP_IF_NZERO) &&
+                same_value(instrs[j].arg1, last.result);
+            const bool const_assign = last.opcode == Instruction::ASSIGN && last.arg1.kind == Operand::CONST &&
+                (j == instrs.size() || instrs[j].opcode == Instruction::JUMP);
+            if (feeds_branch || const_assign) --end;
+
+            if (end - i >= 2) regions.emplace_back(i, end);
+            i = j;
+        }
+        if (regions.empty()) continue;
+
+        // 反向遍历时区域出口按从后往前的顺序出现；执行不到的尾部不会被访问，跳过那里的区域
+        std::vector<LiveSet> live_out(regions.size());
+        int next_exit = (int)regions.size() - 1;
+        liveness.walkBlockBackward(func, b, [&](int i, const LiveSet& live) {
+            while (next_exit >= 0 && regions[next_exit].second - 1 > (size_t)i) --next_exit;
+            if (next_exit >= 0 && regions[next_exit].second - 1 == (size_t)i) live_out[next_exit--] = live;
+        });
+
+        for (size_t r = 0; r < regions.size(); ++r) {
+            const size_t i = regions[r].first;
+            const size_t end = regions[r].second;
+            // 块里执行不到的部分没有活跃信息，也不值得调度
+            if (live_out[r].size() == liveness.numValues()) {
+                const int n = (int)(end - i);
+                Graph g(n);
+                g.reads.resize(n);
+                g.writes.resize(n);
+                std::unordered_map<ValueKey, int> last_def;
+                std::unordered_map<ValueKey, std::vector<int>> uses_since_def;
+                // 变量在区域里每被赋值一次就是一个新的值；version 记下每个变量当前的值编号
+                std::unordered_map<int, int> version;
+                auto new_value = [&](bool live_in) {
+                    g.live_in.push_back(live_in);
+                    g.live_out.push_back(false);
+                    return (int)g.live_out.size() - 1;
+                };
+                for (int k = 0; k < n; ++k) {
+                    const Instruction& instr = instrs[i + k];
+                    g.latency[k] = m_model.latency(instr);
+                    for_each_use(instr, [&](const Operand& op) {
+                        const int idx = liveness.indexOf(op);
+                        if (idx < 0) return;
+                        const ValueKey key = Liveness::keyOf(op);
+                        auto it = last_def.find(key);
+                        if (it != last_def.end()) g.addEdge(it->second, k, g.latency[it->second]);
+                        uses_since_def[key].push_back(k);
+                        auto ver = version.find(idx);
+                        if (ver == version.end()) ver = version.emplace(idx, new_value(true)).first;
+                        auto& reads = g.reads[k];
+                        if (std::find(reads.begin(), reads.end(), ver->second) == reads.end()) reads.push_back(ver->second);
+                    });
+                    if (const Operand* def = instr_def(instr)) {
+                        const int idx = liveness.indexOf(*def);
+                        const ValueKey key = Liveness::keyOf(*def);
+                        auto& uses = uses_since_def[key];
+                        for (int u : uses) {
+                            if (u != k) g.addEdge(u, k, 0);
+                        }
+                        uses.clear();
+                        auto it = last_def.find(key);
+                        if (it != last_def.end()) g.addEdge(it->second, k, 0);
+                        last_def[key] = k;
+                        const int value = new_value(false);
+                        version[idx] = value;
+                        g.writes[k].push_back(value);
+                    }
+                }
+                // 只有每个变量最后的那个值可能活过区域出口
+                for (const auto& ver : version) g.live_out[ver.second] = live_out[r][ver.first];
+                const std::vector<int> order = schedule(g, PreRA);
+                std::vector<Instruction> region;
+                region.reserve(n);
+                for (int v : order) region.push_back(instrs[i + v]);
+                std::copy(region.begin(), region.end(), instrs.begin() + i);
+            }
+        }
+    }
+}
+
+void InstructionScheduler::scheduleMachine(MachineFunction& mf) {
+    for (auto& mbb : mf.blocks) {
+        auto& instrs = mbb.instrs;
+        size_t limit = instrs.size();
+        if (limit > 0 && instrs.back().isTerminator()) --limit;
+        for (size_t i = 0; i < limit;) {
+            if (instrs[i].opcode == MI::CALL) {
+                ++i;
+                continue;
+            }
+            size_t j = i;
+            while (j < limit && instrs[j].opcode != MI::CALL) ++j;
+
+            if (j - i >= 2) {
+                const int n = (int)(j - i);
+                Graph g(n);
+                int last_def[NUM_PHYS_REGS];
+                std::fill(last_def, last_def + NUM_PHYS_REGS, -1);
+                std::vector<int> uses_since_def[NUM_PHYS_REGS];
+                std::vector<int> memory;
+                for (int k = 0; k < n; ++k) {
+                    const MachineInstr& mi = instrs[i + k];
+                    g.latency[k] = m_model.latency(mi.opcode);
+                    const uint32_t use = mi.useMask(), def = mi.defMask();
+                    for (int r = 0; r < NUM_PHYS_REGS; ++r) {
+                        if (!(use & (1u << r))) continue;
+                        if (last_def[r] >= 0) g.addEdge(last_def[r], k, g.latency[last_def[r]]);
+                        uses_since_def[r].push_back(k);
+                    }
+                    for (int r = 0; r < NUM_PHYS_REGS; ++r) {
+                        if (!(def & (1u << r))) continue;
+                        for (int u : uses_since_def[r]) {
+                            if (u != k) g.addEdge(u, k, 0);
+                        }
+                        uses_since_def[r].clear();
+                        if (last_def[r] >= 0) g.addEdge(last_def[r], k, 0);
+                        last_def[r] = k;
+                    }
+                    if (is_memory(mi)) {
+                        for (int m : memory) {
+                            const MachineInstr& prev = instrs[i + m];
+                            if ((prev.opcode == MI::SW || mi.opcode == MI::SW) && may_alias(prev, mi)) g.addEdge(m, k, 0);
+                        }
+                        memory.push_back(k);
+                    }
+                }
+                const std::vector<int> order = schedule(g, PostRA);
+                std::vector<MachineInstr> region;
+                region.reserve(n);
+                for (int v : order) region.push_back(instrs[i + v]);
+                std::copy(region.begin(), region.end(), instrs.begin() + i);
+            }
+            i = j;
+        }
+    }
+}
+
+void InstructionScheduler::printStats(std::ostream& os) const {
+    static const char* const names[NumPhases] = { "pre-ra", "post-ra" };
+    os << "===== Scheduler statistics =====\n";
+    os << std::left << std::setw(10) << "phase" << std::right << std::setw(10) << "regions" << std::setw(10) << "moved"
+       << std::setw(16) << "cycles(before)" << std::setw(16) << "cycles(after)" << "\n";
+    for (int p = 0; p < NumPhases; ++p) {
+        const PhaseStats& s = m_stats[p];
+        os << std::left << std::setw(10) << names[p] << std::right << std::setw(10) << s.regions << std::setw(10) << s.moved
+           << std::setw(16) << s.cycles_before << std::setw(16) << s.cycles_after << "\n";
+    }
+}
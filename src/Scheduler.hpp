@@ -0,0 +1,93 @@
+#pragma once
+
+#include "ir.hpp"
+#include "MachineIR.hpp"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct SchedModel
+ * @brief 调度用的目标延迟模型
+ *
+ * 单发射、顺序执行的流水线：每周期发射一条指令，源寄存器没准备好就停顿。
+ * 各类指令的结果延迟（周期数）从目标描述文件读入，格式是每行 `类别 延迟`，`#` 之后是注释：
+ *   alu  1    # 其余的运算、li/mv
+ *   load 3    # lw 到使用之间的延迟
+ *   mul  3    # mul/mulh
+ *   div  20   # div/rem
+ * 文件里没写的类别保持默认值（与 targets/rv32-inorder.sched 相同）。
+ */
+struct SchedModel {
+    int alu = 1;
+    int load = 3;
+    int mul = 3;
+    int div = 20;
+
+    // 解析目标描述；出错时返回 false，并在 error 里给出行号和原因
+    bool parse(std::istream& in, std::string& error);
+    bool loadFile(const std::string& path, std::string& error);
+
+    int latency(MachineInstr::Opcode op) const;
+    int latency(const Instruction& instr) const;
+};
+
+/**
+ * @class InstructionScheduler
+ * @brief 基本块内的表调度
+ *
+ * 把块切成若干调度区域（调用、参数传递和块末的转移指令是区域的边界），
+ * 在区域内按数据相关（写后读带上生产者的延迟，读后写、写后写只保序）建依赖图，
+ * 然后按模型逐周期模拟：每周期从已就绪的指令中选关键路径最长的一条发射，
+ * 没有就绪的指令时选最早就绪的那条（即停顿）。关键路径相同时保持原来的顺序。
+ *   - scheduleIR：寄存器分配之前，在三地址 IR 的块上调度，依赖按变量/临时变量计算。
+ *     同时跟踪区域内同时活跃的值的个数，不让它超过原顺序的峰值，免得提前的乘除法造成溢出。
+ *     紧接在条件跳转前、结果只给它用的比较，以及块末的常量赋值，留在原位，
+ *     好让指令选择仍能把它们和跳转合并。
+ *   - scheduleMachine：寄存器分配和窥孔优化之后，在 MachineFunction 的块上调度，
+ *     依赖按物理寄存器计算；访存之间只有基址相同、偏移不重叠的才认为无关。
+ * 两边共用同一个模型，统计估计的停顿周期（按区域内的模拟）供 -time-passes 打印。
+ */
+class InstructionScheduler {
+public:
+    explicit InstructionScheduler(const SchedModel& model = SchedModel()) : m_model(model) {}
+
+    void scheduleIR(FunctionIR& func);
+    void scheduleMachine(MachineFunction& mf);
+
+    void printStats(std::ostream& os) const;
+
+    // 一个调度区域的依赖图；边总是从原顺序在前的指令指向在后的指令
+    struct Graph {
+        struct Edge { int to; int latency; };
+        std::vector<std::vector<Edge>> succs;
+        std::vector<int> latency; // 每条指令结果的延迟
+
+        // 寄存器压力（只在分配之前跟踪）：每条指令读/写的值的编号，
+        // 以及哪些值在区域入口/出口活跃。为空时不考虑压力
+        std::vector<std::vector<int>> reads, writes;
+        std::vector<char> live_in, live_out;
+
+        explicit Graph(int n) : succs(n), latency(n, 1) {}
+        int size() const { return (int)latency.size(); }
+        void addEdge(int from, int to, int lat) { succs[from].push_back({ to, lat }); }
+        bool tracksPressure() const { return !live_out.empty(); }
+    };
+
+private:
+    enum Phase { PreRA, PostRA, NumPhases };
+
+    struct PhaseStats {
+        long regions = 0;
+        long moved = 0;         // 位置变化的指令数
+        long cycles_before = 0; // 按模型估计的区域周期数
+        long cycles_after = 0;
+    };
+
+    // 给出区域的新顺序（下标的排列）并记入统计
+    std::vector<int> schedule(const Graph& g, Phase phase);
+
+    SchedModel m_model;
+    PhaseStats m_stats[NumPhases];
+};
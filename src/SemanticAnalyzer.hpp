@@ -1,50 +1,54 @@
 #pragma once
 
 #include "ast.hpp"
+#include "CompilationContext.hpp"
 #include <stack>
 #include <unordered_map>
 #include <string>
-#include <iostream> // ڴӡϢ
 
-// ڴ洢ţϢ
+// 用于存储符号（变量、函数）的信息
 struct SymbolInfo {
     TypeKind type;
-    // δչ洢бǷǳ
+    // 未来可以扩展，例如存储函数参数类型列表、是否是常量等
 };
 
-// ̳࣬ Visitor AST ִм
+// 语义分析器类，继承自 Visitor，负责遍历 AST 并执行检查
+// 发现的错误记在 CompilationContext 的诊断里（phase 为 "Semantic"），由调用者决定是否继续编译
 class SemanticAnalyzer : public Visitor {
 private:
-    // ʹ vector ģջֲ֧
-    std::vector<std::unordered_map<std::string, SymbolInfo>> scopes;
+    CompilationContext& ctx;
 
-    // ٵǰǷѭڣڼ break/continue
+    // 使用 vector 来模拟作用域栈，支持查找
+    std::vector<std::unordered_map<Symbol, SymbolInfo>> scopes;
+
+    // 跟踪当前是否在循环内，用于检查 break/continue
     int loop_depth = 0;
 
-    // ָǰڷĺڼ return 
+    // 指向当前正在分析的函数，用于检查 return 类型
     FuncDef* current_function = nullptr;
 
-    // ű (ʵ .cpp ļ)
+    // 符号表辅助函数 (具体实现在 .cpp 文件中)
     void enter_scope();
     void exit_scope();
-    bool declare(const std::string& name, SymbolInfo info); // һ·
-    SymbolInfo* lookup(const std::string& name);            // һ
+    bool declare(Symbol name, SymbolInfo info, const Node* where); // 声明一个新符号
+    SymbolInfo* lookup(Symbol name);                       // 查找一个符号
+    void error(const Node* where, const std::string& message);   // 按节点的行号报告错误
 
 public:
-    SemanticAnalyzer() = default;
+    explicit SemanticAnalyzer(CompilationContext& ctx) : ctx(ctx) {}
 
-    // 
+    // 分析入口
     void analyze(Program* root);
 
-    // --- Visitor ӿʵ ---
-    // д visit Щľʵֽ SemanticAnalyzer.cpp 
+    // --- Visitor 接口实现 ---
+    // 重写所有 visit 方法的声明，这些方法的具体实现将在 SemanticAnalyzer.cpp 中完成
 
-    // 뺯
+    // 程序与函数
     void visit(Program* node) override;
     void visit(FuncDef* node) override;
     void visit(Param* node) override;
 
-    // 
+    // 语句
     void visit(Block* node) override;
     void visit(ExprStmt* node) override;
     void visit(AssignStmt* node) override;
@@ -55,7 +59,7 @@ public:
     void visit(IfStmt* node) override;
     void visit(WhileStmt* node) override;
 
-    // ʽ
+    // 表达式
     void visit(IntLiteral* node) override;
     void visit(VarExpr* node) override;
     void visit(BinaryExpr* node) override;
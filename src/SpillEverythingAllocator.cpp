@@ -1,113 +1,115 @@
 #include "SpillEverythingAllocator.hpp"
-#include <sstream>
 #include <algorithm>
 
-std::string SpillEverythingAllocator::operandToKey(const Operand& op) {
-    if (op.kind == Operand::VAR) return op.name;
-    if (op.kind == Operand::TEMP) return "t" + std::to_string(op.id);
-    return "";
+// op 的栈槽（没有分配时为 -1）；不是 VAR/TEMP 时返回 nullptr
+int* SpillEverythingAllocator::slotOf(const Operand& op) {
+    if (!is_value(op)) return nullptr;
+    return &m_offsets.emplace(value_key(op), -1).first->second;
 }
 
-std::string SpillEverythingAllocator::offsetToString(int offset) {
-    return std::to_string(offset) + "(fp)";
+int SpillEverythingAllocator::offsetOf(const Operand& op) const {
+    if (!is_value(op)) return -1;
+    auto it = m_offsets.find(value_key(op));
+    return it == m_offsets.end() ? -1 : it->second;
 }
 
-void SpillEverythingAllocator::prepare(const FunctionIR& func) {
-    m_func_name = func.name;
-    m_stack_offsets.clear();
-    int current_offset = 0;
+void SpillEverythingAllocator::prepare(const FunctionIR& func, const std::unordered_set<ValueKey>& folded) {
+    m_offsets.clear();
+    m_ra_offset = -1;
+    // 栈帧最底部是传出参数区
+    int current_offset = outgoing_args_size(func);
 
-    // Ϊ ra  fp ̶λ
-    current_offset -= 4;
-    const int ra_offset = current_offset;
-    m_stack_offsets["<ra>"] = ra_offset; // ʹ
-    current_offset -= 4;
-    const int old_fp_offset = current_offset;
-    m_stack_offsets["<old_fp>"] = old_fp_offset;
-
-    // Ϊбʱջռ
+    // 为所有变量和临时结果分配栈空间（相对 sp，在传出参数区之上）；从不写出的值不占栈槽
     auto allocate_if_needed = [&](const Operand& op) {
-        std::string key = operandToKey(op);
-        if (!key.empty() && m_stack_offsets.find(key) == m_stack_offsets.end()) {
-            current_offset -= 4;
-            m_stack_offsets[key] = current_offset;
+        if (is_value(op) && folded.count(value_key(op))) return;
+        int* slot = slotOf(op);
+        if (slot && *slot < 0) {
+            *slot = current_offset;
+            current_offset += 4;
         }
     };
 
+    // 第 9 个起的参数已经在调用者的栈帧里，直接用那个位置，等栈帧大小确定后再填偏移
+    for (size_t i = kNumArgRegs; i < func.params.size(); ++i) *slotOf({ Operand::VAR, func.params[i].name }) = 0;
+
+    bool calls = false;
     for (const auto& param : func.params) allocate_if_needed({ Operand::VAR, param.name });
     for (const auto& bb : func.blocks) {
         for (const auto& instr : bb.instructions) {
             allocate_if_needed(instr.result);
             allocate_if_needed(instr.arg1);
             allocate_if_needed(instr.arg2);
+            calls = calls || instr.opcode == Instruction::CALL;
         }
     }
 
-    m_total_stack_size = -current_offset;
-    // 16ֽڶ
+    // 调用了别的函数才需要保存 ra；帧指针不用，也就不必保存 fp
+    if (calls) {
+        m_ra_offset = current_offset;
+        current_offset += 4;
+    }
+
+    m_total_stack_size = current_offset;
+    // 16字节对齐
     if (m_total_stack_size % 16 != 0) {
         m_total_stack_size += 16 - (m_total_stack_size % 16);
     }
 
-    std::stringstream ss;
-    for (size_t i = 0; i < func.params.size(); ++i) {
-        std::string key = operandToKey({ Operand::VAR, func.params[i].name });
-        if (m_stack_offsets.count(key)) {
-            ss << "  sw a" << i << ", " << offsetToString(m_stack_offsets[key]) << "\n";
+    for (size_t i = kNumArgRegs; i < func.params.size(); ++i) {
+        *slotOf({ Operand::VAR, func.params[i].name }) = m_total_stack_size + stack_arg_offset((int)i);
+    }
+
+    m_param_init_code.clear();
+    for (size_t i = 0; i < func.params.size() && i < (size_t)kNumArgRegs; ++i) {
+        const int offset = offsetOf({ Operand::VAR, func.params[i].name });
+        if (offset >= 0) {
+            m_param_init_code.emplace_back(MachineInstr::SW, MachineOperand::r(arg_reg((int)i)), MachineOperand::mem(offset, SP));
         }
     }
-    m_param_init_code = ss.str();
 }
 
-std::string SpillEverythingAllocator::getPrologue() {
-    std::stringstream ss;
-    ss << m_func_name << ":\n";
+void SpillEverythingAllocator::emitPrologue(std::vector<MachineInstr>& out) {
     if (m_total_stack_size > 0) {
-        ss << "  addi sp, sp, -" << m_total_stack_size << "\n";
-        ss << "  sw ra, " << (m_total_stack_size - 4) << "(sp)\n";
-        ss << "  sw fp, " << (m_total_stack_size - 8) << "(sp)\n";
-        ss << "  addi fp, sp, " << m_total_stack_size << "\n";
+        out.emplace_back(MachineInstr::ADDI, MachineOperand::r(SP), MachineOperand::r(SP), MachineOperand::imm(-m_total_stack_size));
     }
-    // Ӳָ
-    if (!m_param_init_code.empty()) {
-        ss << m_param_init_code;
+    if (m_ra_offset >= 0) {
+        out.emplace_back(MachineInstr::SW, MachineOperand::r(RA), MachineOperand::mem(m_ra_offset, SP));
     }
+    // 添加参数保存指令
+    out.insert(out.end(), m_param_init_code.begin(), m_param_init_code.end());
+}
 
-    return ss.str();
+void SpillEverythingAllocator::emitEpilogue(std::vector<MachineInstr>& out) {
+    emitTeardown(out);
+    out.emplace_back(MachineInstr::RET);
 }
 
-std::string SpillEverythingAllocator::getEpilogue() {
-    std::stringstream ss;
+void SpillEverythingAllocator::emitTeardown(std::vector<MachineInstr>& out) {
+    if (m_ra_offset >= 0) {
+        out.emplace_back(MachineInstr::LW, MachineOperand::r(RA), MachineOperand::mem(m_ra_offset, SP));
+    }
     if (m_total_stack_size > 0) {
-        ss << "  lw ra, " << offsetToString(m_stack_offsets["<ra>"]) << "\n";
-        ss << "  lw fp, " << offsetToString(m_stack_offsets["<old_fp>"]) << "\n";
-        ss << "  addi sp, sp, " << m_total_stack_size << "\n";
+        out.emplace_back(MachineInstr::ADDI, MachineOperand::r(SP), MachineOperand::r(SP), MachineOperand::imm(m_total_stack_size));
     }
-    ss << "  ret\n";
-    return ss.str();
 }
 
-std::string SpillEverythingAllocator::loadOperand(const Operand& op, const std::string& destReg) {
-    std::stringstream ss;
+void SpillEverythingAllocator::loadOperand(const Operand& op, PhysReg destReg, std::vector<MachineInstr>& out) {
     if (op.kind == Operand::CONST) {
-        ss << "  li " << destReg << ", " << op.value << "\n";
+        out.emplace_back(MachineInstr::LI, MachineOperand::r(destReg), MachineOperand::imm(op.value));
     }
     else {
-        std::string key = operandToKey(op);
-        if (m_stack_offsets.count(key)) {
-            ss << "  lw " << destReg << ", " << offsetToString(m_stack_offsets.at(key)) << "\n";
+        const int offset = offsetOf(op);
+        if (offset >= 0) {
+            out.emplace_back(MachineInstr::LW, MachineOperand::r(destReg), MachineOperand::mem(offset, SP));
         }
     }
-    return ss.str();
 }
 
-std::string SpillEverythingAllocator::storeOperand(const Operand& result, const std::string& srcReg) {
-    std::stringstream ss;
-    std::string key = operandToKey(result);
-    if (m_stack_offsets.count(key)) {
-        ss << "  sw " << srcReg << ", " << offsetToString(m_stack_offsets.at(key)) << "\n";
+void SpillEverythingAllocator::storeOperand(const Operand& result, PhysReg srcReg, std::vector<MachineInstr>& out) {
+    const int offset = offsetOf(result);
+    if (offset >= 0) {
+        out.emplace_back(MachineInstr::SW, MachineOperand::r(srcReg), MachineOperand::mem(offset, SP));
     }
-    return ss.str();
 }
 
 int SpillEverythingAllocator::getTotalStackSize() const {
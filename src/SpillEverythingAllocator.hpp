@@ -1,22 +1,24 @@
 #pragma once
 
 #include "RegisterAllocator.hpp"
+#include <unordered_map>
 
 class SpillEverythingAllocator : public RegisterAllocator {
 public:
-    void prepare(const FunctionIR& func) override;
-    std::string getPrologue() override;
-    std::string getEpilogue() override;
-    std::string loadOperand(const Operand& op, const std::string& destReg) override;
-    std::string storeOperand(const Operand& result, const std::string& srcReg) override;
+    void prepare(const FunctionIR& func, const std::unordered_set<ValueKey>& folded) override;
+    void emitPrologue(std::vector<MachineInstr>& out) override;
+    void emitEpilogue(std::vector<MachineInstr>& out) override;
+    void emitTeardown(std::vector<MachineInstr>& out) override;
+    void loadOperand(const Operand& op, PhysReg destReg, std::vector<MachineInstr>& out) override;
+    void storeOperand(const Operand& result, PhysReg srcReg, std::vector<MachineInstr>& out) override;
     int getTotalStackSize() const override;
 
 private:
-    std::string operandToKey(const Operand& op);
-    std::string offsetToString(int offset);
+    int* slotOf(const Operand& op);
+    int offsetOf(const Operand& op) const;
 
-    std::string m_func_name;
     int m_total_stack_size = 0;
-    std::map<std::string, int> m_stack_offsets;
-    std::string m_param_init_code;
+    std::unordered_map<ValueKey, int> m_offsets; // 值 -> 栈槽偏移，只含这个函数里出现的值
+    int m_ra_offset = -1; // 保存 ra 的位置；不调用别的函数时为 -1
+    std::vector<MachineInstr> m_param_init_code;
 };
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "StrengthReduction.hpp"
+#include <utility>
+
+using MI = MachineInstr;
+using MO = MachineOperand;
+
+namespace {
+
+// 2 的幂返回指数，否则返回 -1
+int log2_exact(uint64_t v) {
+    if (v == 0 || (v & (v - 1)) != 0) return -1;
+    int k = 0;
+    while ((v >> k) != 1) ++k;
+    return k;
+}
+
+// 削弱后的乘法序列最多几条指令；再长就不如 li + mul
+const size_t kMaxMulSequence = 3;
+
+// rs << k 放到 tmp 里；k 为 0 时不用生成指令，直接用 rs
+PhysReg shifted(PhysReg rs, int k, PhysReg tmp, std::vector<MI>& seq) {
+    if (k == 0) return rs;
+    seq.emplace_back(MI::SLLI, MO::r(tmp), MO::r(rs), MO::imm(k));
+    return tmp;
+}
+
+// 有符号除以 ±2^k 的向零取整需要的偏置：被除数为负时是 2^k - 1，否则是 0。结果放在 t1
+void emit_pow2_bias(PhysReg rs, int k, PhysReg t1, std::vector<MI>& out) {
+    if (k == 1) {
+        out.emplace_back(MI::SRLI, MO::r(t1), MO::r(rs), MO::imm(31));
+    }
+    else {
+        out.emplace_back(MI::SRAI, MO::r(t1), MO::r(rs), MO::imm(31));
+        out.emplace_back(MI::SRLI, MO::r(t1), MO::r(t1), MO::imm(32 - k));
+    }
+}
+
+// 商 n / d 放到 t1（d 不是 0、±1 或 ±2 的幂），t2 被改写
+void emit_magic_quotient(PhysReg rs, int32_t d, PhysReg t1, PhysReg t2, std::vector<MI>& out) {
+    SignedMagic mag = signed_magic(d);
+    out.emplace_back(MI::LI, MO::r(t1), MO::imm(mag.multiplier));
+    out.emplace_back(MI::MULH, MO::r(t1), MO::r(rs), MO::r(t1));
+    if (d > 0 && mag.multiplier < 0) out.emplace_back(MI::ADD, MO::r(t1), MO::r(t1), MO::r(rs));
+    if (d < 0 && mag.multiplier > 0) out.emplace_back(MI::SUB, MO::r(t1), MO::r(t1), MO::r(rs));
+    if (mag.shift > 0) out.emplace_back(MI::SRAI, MO::r(t1), MO::r(t1), MO::imm(mag.shift));
+    // 商为负时加 1，得到向零取整的结果
+    out.emplace_back(MI::SRLI, MO::r(t2), MO::r(t1), MO::imm(31));
+    out.emplace_back(MI::ADD, MO::r(t1), MO::r(t1), MO::r(t2));
+}
+
+} // namespace
+
+// Hacker's Delight 10-1 节的算法：找最小的 p，使 2^p / |d| 的上取整可以作为乘数
+SignedMagic signed_magic(int32_t d) {
+    const uint32_t two31 = 0x80000000u;
+    const uint32_t ad = d < 0 ? 0u - (uint32_t)d : (uint32_t)d;
+    const uint32_t t = two31 + ((uint32_t)d >> 31);
+    const uint32_t anc = t - 1 - t % ad; // |nc|
+    int p = 31;
+    uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc; // 2^p / |nc| 的商和余数
+    uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;   // 2^p / |d| 的商和余数
+    uint32_t delta;
+    do {
+        ++p;
+        q1 *= 2; r1 *= 2;
+        if (r1 >= anc) { ++q1; r1 -= anc; }
+        q2 *= 2; r2 *= 2;
+        if (r2 >= ad) { ++q2; r2 -= ad; }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    SignedMagic mag;
+    mag.multiplier = (int32_t)(q2 + 1);
+    if (d < 0) mag.multiplier = (int32_t)(0u - (q2 + 1));
+    mag.shift = p - 32;
+    return mag;
+}
+
+bool expand_mul_by_constant(PhysReg rd, PhysReg rs, int32_t c, PhysReg t1, PhysReg t2, std::vector<MI>& out) {
+    if (c == 0) {
+        out.emplace_back(MI::LI, MO::r(rd), MO::imm(0));
+        return true;
+    }
+    const bool negative = c < 0;
+    const uint64_t ac = negative ? 0u - (uint32_t)c : (uint32_t)c;
+    const uint64_t low = ac & (0 - ac); // 最低的一位
+    const int k = log2_exact(ac);
+    const int b = log2_exact(low);
+    std::vector<MI> seq;
+
+    if (k >= 0) {
+        // ±2^k：一次左移（再取负）
+        if (negative) {
+            PhysReg x = shifted(rs, k, t1, seq);
+            seq.emplace_back(MI::NEG, MO::r(rd), MO::r(x));
+        }
+        else if (k == 0) seq.emplace_back(MI::MV, MO::r(rd), MO::r(rs));
+        else seq.emplace_back(MI::SLLI, MO::r(rd), MO::r(rs), MO::imm(k));
+    }
+    else if (log2_exact(ac - low) >= 0) {
+        // 2^a + 2^b：两次左移后相加
+        PhysReg x = shifted(rs, log2_exact(ac - low), t1, seq);
+        PhysReg y = shifted(rs, b, t2, seq);
+        PhysReg sum = negative ? t1 : rd;
+        seq.emplace_back(MI::ADD, MO::r(sum), MO::r(x), MO::r(y));
+        if (negative) seq.emplace_back(MI::NEG, MO::r(rd), MO::r(sum));
+    }
+    else if (log2_exact(ac + low) >= 0) {
+        // 2^a - 2^b：两次左移后相减；取负只需交换被减数和减数
+        PhysReg x = shifted(rs, log2_exact(ac + low), t1, seq);
+        PhysReg y = shifted(rs, b, t2, seq);
+        if (negative) std::swap(x, y);
+        seq.emplace_back(MI::SUB, MO::r(rd), MO::r(x), MO::r(y));
+    }
+    else {
+        return false;
+    }
+
+    if (seq.size() > kMaxMulSequence) return false;
+    out.insert(out.end(), seq.begin(), seq.end());
+    return true;
+}
+
+bool expand_div_by_constant(PhysReg rd, PhysReg rs, int32_t d, PhysReg t1, PhysReg t2, std::vector<MI>& out) {
+    // 除以 0 留给 div 指令（结果由硬件定义），INT_MIN 不值得特殊处理
+    if (d == 0 || d == INT32_MIN) return false;
+    if (d == 1) {
+        out.emplace_back(MI::MV, MO::r(rd), MO::r(rs));
+        return true;
+    }
+    if (d == -1) {
+        out.emplace_back(MI::NEG, MO::r(rd), MO::r(rs));
+        return true;
+    }
+
+    const uint32_t ad = d < 0 ? 0u - (uint32_t)d : (uint32_t)d;
+    const int k = log2_exact(ad);
+    if (k >= 0) {
+        // (n + bias) >> k；除数为负时再取负
+        emit_pow2_bias(rs, k, t1, out);
+        out.emplace_back(MI::ADD, MO::r(t1), MO::r(t1), MO::r(rs));
+        PhysReg q = d < 0 ? t1 : rd;
+        out.emplace_back(MI::SRAI, MO::r(q), MO::r(t1), MO::imm(k));
+        if (d < 0) out.emplace_back(MI::NEG, MO::r(rd), MO::r(q));
+        return true;
+    }
+
+    emit_magic_quotient(rs, d, t1, t2, out);
+    out.back().ops[0] = MO::r(rd);
+    return true;
+}
+
+bool expand_rem_by_constant(PhysReg rd, PhysReg rs, int32_t d, PhysReg t1, PhysReg t2, std::vector<MI>& out) {
+    if (d == 0 || d == INT32_MIN) return false;
+    if (d == 1 || d == -1) {
+        out.emplace_back(MI::LI, MO::r(rd), MO::imm(0));
+        return true;
+    }
+
+    // 余数与被除数同号，和除数的符号无关：n % d == n % |d|
+    const uint32_t ad = d < 0 ? 0u - (uint32_t)d : (uint32_t)d;
+    const int k = log2_exact(ad);
+    if (k >= 0) {
+        // n - ((n + bias) & -2^k)
+        emit_pow2_bias(rs, k, t1, out);
+        out.emplace_back(MI::ADD, MO::r(t2), MO::r(rs), MO::r(t1));
+        if (fits_imm12(-(1L << k))) {
+            out.emplace_back(MI::ANDI, MO::r(t2), MO::r(t2), MO::imm(-(1 << k)));
+        }
+        else {
+            out.emplace_back(MI::SRAI, MO::r(t2), MO::r(t2), MO::imm(k));
+            out.emplace_back(MI::SLLI, MO::r(t2), MO::r(t2), MO::imm(k));
+        }
+        out.emplace_back(MI::SUB, MO::r(rd), MO::r(rs), MO::r(t2));
+        return true;
+    }
+
+    // n - (n / d) * d
+    emit_magic_quotient(rs, d, t1, t2, out);
+    out.emplace_back(MI::LI, MO::r(t2), MO::imm(d));
+    out.emplace_back(MI::MUL, MO::r(t2), MO::r(t1), MO::r(t2));
+    out.emplace_back(MI::SUB, MO::r(rd), MO::r(rs), MO::r(t2));
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "MachineIR.hpp"
+#include <vector>
+
+// --- 常量乘除的强度削弱 ---
+// 指令选择遇到 `x * c`、`x / c`、`x % c`（c 为编译期常量）时调用这里的函数，
+// 用移位/加减代替 mul，用带偏置的移位或“魔数”乘高位（mulh）代替 div/rem。
+// 结果与 RV32M 的 mul/div/rem 逐位相同（有符号、向零取整，余数与被除数同号）。
+//
+// 约定：rs 是被操作数，rd 是结果；t1、t2 是可以随意改写的临时寄存器，且与 rs 不同。
+// rd 只在序列的最后一条指令写入，所以可以与 rs 或 t1、t2 相同。
+// 成功时把指令序列追加到 out 并返回 true；不划算或不支持时什么都不做并返回 false，
+// 调用者退回普通的 mul/div/rem。
+
+bool expand_mul_by_constant(PhysReg rd, PhysReg rs, int32_t c, PhysReg t1, PhysReg t2, std::vector<MachineInstr>& out);
+bool expand_div_by_constant(PhysReg rd, PhysReg rs, int32_t d, PhysReg t1, PhysReg t2, std::vector<MachineInstr>& out);
+bool expand_rem_by_constant(PhysReg rd, PhysReg rs, int32_t d, PhysReg t1, PhysReg t2, std::vector<MachineInstr>& out);
+
+// 有符号除以 d 的魔数：q = (mulh(n, multiplier) [+/- n]) >> shift，再加上符号位修正。
+// d 不能是 0、±1，也不能是 2 的幂（它们有更简单的序列）。
+struct SignedMagic {
+    int32_t multiplier;
+    int shift;
+};
+SignedMagic signed_magic(int32_t d);
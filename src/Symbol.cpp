@@ -0,0 +1,70 @@
+#include "Symbol.hpp"
+#include <stdexcept>
+
+namespace {
+
+// 当前线程绑定的符号表（SymbolTable::Scope 设置）
+thread_local SymbolTable* t_current = nullptr;
+
+SymbolTable& current_table() {
+    if (!t_current) {
+        throw std::runtime_error("Symbol Error: no symbol table is bound to this thread.");
+    }
+    return *t_current;
+}
+
+const std::string& empty_string() {
+    static const std::string s;
+    return s;
+}
+
+} // namespace
+
+// --- SymbolTable ---
+
+SymbolTable::SymbolTable() {
+    // 编号 0 是空串
+    m_strings.emplace_back();
+    m_index.emplace(std::string(), 0);
+}
+
+uint32_t SymbolTable::intern(const std::string& text) {
+    auto it = m_index.find(text);
+    if (it != m_index.end()) return it->second;
+    const uint32_t id = (uint32_t)m_strings.size();
+    m_strings.push_back(text);
+    m_index.emplace(text, id);
+    return id;
+}
+
+SymbolTable* SymbolTable::current() {
+    return t_current;
+}
+
+SymbolTable::Scope::Scope(SymbolTable& table) : m_previous(t_current) {
+    t_current = &table;
+}
+
+SymbolTable::Scope::~Scope() {
+    t_current = m_previous;
+}
+
+// --- Symbol ---
+
+Symbol Symbol::intern(const std::string& text) {
+    return fromId(current_table().intern(text));
+}
+
+Symbol Symbol::intern(const char* text) {
+    return intern(std::string(text));
+}
+
+uint32_t Symbol::count() {
+    return current_table().count();
+}
+
+const std::string& Symbol::str() const {
+    // 空串不查表：默认构造的 Symbol 在没有绑定符号表的地方也能打印
+    if (m_id == 0) return empty_string();
+    return current_table().at(m_id);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class Symbol
+ * @brief 驻留的名字（变量名、函数名、标签）
+ *
+ * 同样内容的字符串在符号表里只存一份，Symbol 只是它的 32 位编号：
+ * 复制、比较、求哈希都是整数运算，可以直接放进 POD 结构（如 Operand），
+ * 也可以用编号当下标查 vector。编号 0 固定是空串，默认构造的 Symbol 就是它。
+ * 编号只在一张符号表里有意义：intern/str/count 用的是当前线程绑定的 SymbolTable
+ * （见 SymbolTable::Scope，通常由 CompilationContext 绑定），没有绑定时除空串外都会抛异常。
+ */
+class Symbol {
+public:
+    Symbol() = default;
+
+    // 取得 text 的编号，第一次出现时加入符号表
+    static Symbol intern(const std::string& text);
+    static Symbol intern(const char* text);
+    // 由编号还原（编号必须来自 id()）
+    static Symbol fromId(uint32_t id) { Symbol s; s.m_id = id; return s; }
+    // 符号表中的符号个数，编号都小于它
+    static uint32_t count();
+
+    uint32_t id() const { return m_id; }
+    const std::string& str() const;
+    bool empty() const { return m_id == 0; }
+
+    bool operator==(Symbol o) const { return m_id == o.m_id; }
+    bool operator!=(Symbol o) const { return m_id != o.m_id; }
+    // 按编号排序，只用于需要确定顺序的容器，与字典序无关
+    bool operator<(Symbol o) const { return m_id < o.m_id; }
+
+private:
+    uint32_t m_id = 0;
+};
+
+/**
+ * @class SymbolTable
+ * @brief 一次编译的符号表：编号 -> 文本，文本 -> 编号
+ *
+ * 由 CompilationContext 拥有，编号从 0 开始，随这次编译一起释放；不同编译的表互不相干，
+ * 所以按编号开的表只和这次编译的名字个数有关。一张表只在一个线程里使用，不加锁。
+ * Symbol 通过 Scope 找到它：Scope 存在期间，这个线程上的 Symbol::intern/str 都用这张表。
+ */
+class SymbolTable {
+public:
+    SymbolTable();
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    uint32_t intern(const std::string& text);
+    uint32_t count() const { return (uint32_t)m_strings.size(); }
+    // deque 在末尾追加时不移动已有元素，返回的引用在表销毁前一直有效
+    const std::string& at(uint32_t id) const { return m_strings[id]; }
+
+    // 当前线程绑定的表，没有时为 nullptr
+    static SymbolTable* current();
+
+    // 把 table 绑定到当前线程，析构时恢复原来的绑定（可以嵌套）
+    class Scope {
+    public:
+        explicit Scope(SymbolTable& table);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SymbolTable* m_previous;
+    };
+
+private:
+    std::deque<std::string> m_strings;
+    std::unordered_map<std::string, uint32_t> m_index;
+};
+
+inline std::ostream& operator<<(std::ostream& os, Symbol s) { return os << s.str(); }
+inline std::string operator+(const std::string& a, Symbol b) { return a + b.str(); }
+inline std::string operator+(Symbol a, const std::string& b) { return a.str() + b; }
+
+namespace std {
+template<> struct hash<Symbol> {
+    size_t operator()(Symbol s) const { return std::hash<uint32_t>()(s.id()); }
+};
+}
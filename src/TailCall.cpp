@@ -0,0 +1,80 @@
+#include "TailCall.hpp"
+#include "CFG.hpp"
+
+namespace {
+
+const int kMaxRegisterArgs = 8; // 实参都在 a0-a7 里才能复用栈帧
+
+// 块 bb 中第 i 条指令是不是尾调用
+bool is_tail_call(const BasicBlock& bb, int i) {
+    const auto& instrs = bb.instructions;
+    if (i + 1 >= reachable_end(bb)) return false;
+    const Instruction& call = instrs[i];
+    const Instruction& ret = instrs[i + 1];
+    if (call.opcode != Instruction::CALL || ret.opcode != Instruction::RET) return false;
+    if (ret.arg1.kind != Operand::NONE && !same_value(ret.arg1, call.result)) return false;
+    // PARAM 必须紧挨着 CALL
+    const int nargs = call.arg2.value;
+    if (nargs > i) return false;
+    for (int k = i - nargs; k < i; ++k) {
+        if (instrs[k].opcode != Instruction::PARAM) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool TailCallPass::runOnFunction(FunctionIR& func) {
+    if (func.blocks.empty()) return false;
+    bool changed = false;
+    const Symbol entry = func.blocks[0].label;
+
+    for (auto& bb : func.blocks) {
+        auto& instrs = bb.instructions;
+        for (int i = 0; i < (int)instrs.size(); ++i) {
+            if (!is_tail_call(bb, i)) continue;
+            const Instruction call = instrs[i];
+            const int nargs = call.arg2.value;
+
+            if (m_mode == Mode::AllCalls) {
+                if (call.arg1.name == func.name || nargs > kMaxRegisterArgs) continue;
+                instrs[i].opcode = Instruction::TAIL_CALL;
+                instrs[i].result = Operand();
+                instrs.resize(i + 1);
+                changed = true;
+                break;
+            }
+
+            if (call.arg1.name != func.name || nargs != (int)func.params.size()) continue;
+            // 实参可能用到形参本身（如 gcd(b, a % b)），先全部存入临时变量再赋值
+            std::vector<Instruction> tail(instrs.begin(), instrs.begin() + i - nargs);
+            std::vector<Operand> temps;
+            for (int k = 0; k < nargs; ++k) {
+                Instruction save;
+                save.opcode = Instruction::ASSIGN;
+                save.result = make_temp(func);
+                save.arg1 = instrs[i - 1 - k].arg1; // 最后一条 PARAM 是第一个实参
+                temps.push_back(save.result);
+                tail.push_back(save);
+            }
+            for (int k = 0; k < nargs; ++k) {
+                Instruction assign;
+                assign.opcode = Instruction::ASSIGN;
+                assign.result.kind = Operand::VAR;
+                assign.result.name = func.params[k].name;
+                assign.arg1 = temps[k];
+                tail.push_back(assign);
+            }
+            Instruction jump;
+            jump.opcode = Instruction::JUMP;
+            jump.arg1.kind = Operand::LABEL;
+            jump.arg1.name = entry;
+            tail.push_back(jump);
+            instrs = std::move(tail);
+            changed = true;
+            break;
+        }
+    }
+    if (changed) build_cfg(func);
+    return changed;
+}
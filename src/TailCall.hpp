@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ir.hpp"
+#include "Optimizer.hpp"
+
+/**
+ * @class TailCallPass
+ * @brief 尾调用消除
+ *
+ * 尾调用指 CALL 之后紧跟着返回它的结果（或无值的 RET）。
+ *   - SelfRecursion：调用自己的尾调用改成“实参先存入临时变量，再赋给形参，跳回入口块”，
+ *     递归变成循环，之后的 SSA 优化和内联都能看到这个循环。放在流水线最前面。
+ *   - AllCalls：其余的尾调用改成 TAIL_CALL，代码生成时先拆掉自己的栈帧再用 `tail` 跳过去，
+ *     被调用者直接返回到我们的调用者。放在离开 SSA 之后。
+ * 两种情况下递归的栈深度都不再随调用层数增长。
+ */
+class TailCallPass : public FunctionPass {
+public:
+    enum class Mode { SelfRecursion, AllCalls };
+
+    explicit TailCallPass(Mode mode) : m_mode(mode) {}
+    const char* name() const override { return m_mode == Mode::SelfRecursion ? "tailrec" : "tailcall"; }
+    bool runOnFunction(FunctionIR& func) override;
+
+private:
+    Mode m_mode;
+};
@@ -2,10 +2,7 @@
 #include "ast.hpp"
 #include "SemanticAnalyzer.hpp"
 
-std::vector<std::unique_ptr<Node>> g_arena;  //  ǡ塱洢
-Program* g_root = nullptr;
-
-// --- ʽ (Expressions) accept ʵ ---
+// --- 表达式 (Expressions) accept 方法实现 ---
 
 void IntLiteral::accept(Visitor* v) {
     v->visit(this);
@@ -28,7 +25,7 @@ void CallExpr::accept(Visitor* v) {
 }
 
 
-// ---  (Statements) accept ʵ ---
+// --- 语句 (Statements) accept 方法实现 ---
 
 void ExprStmt::accept(Visitor* v) {
     v->visit(this);
@@ -67,7 +64,7 @@ void WhileStmt::accept(Visitor* v) {
 }
 
 
-// ---  (Functions/Program) accept ʵ ---
+// --- 函数与程序 (Functions/Program) accept 方法实现 ---
 
 void Param::accept(Visitor* v) {
     v->visit(this);
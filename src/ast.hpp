@@ -3,22 +3,24 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "Arena.hpp"
+#include "Symbol.hpp"
 
 struct Program;
-class Visitor; // ǰ
-extern Program* g_root;
+class Visitor; // 前向声明
 enum class TypeKind { TY_INT, TY_VOID };
 
 struct Node { virtual ~Node() = default; 
-	virtual void accept(Visitor* v) = 0; //accept,ڼ
+	virtual void accept(Visitor* v) = 0; //accept,用于检查语义
+	int line = 0; // 语法分析归约出这个节点时的行号，语义错误按它报告
 };
 
-// --- ʽ ---
+// --- 表达式 ---
 struct Expr : Node { TypeKind type_val = TypeKind::TY_INT;};
 struct IntLiteral : Expr { int value; explicit IntLiteral(int v) : value(v) {} 
 	void accept(Visitor* v) override;
 };
-struct VarExpr : Expr { std::string name; explicit VarExpr(std::string n) : name(std::move(n)) {} 
+struct VarExpr : Expr { Symbol name; explicit VarExpr(Symbol n) : name(n) {} 
 	void accept(Visitor* v) override;
 };
 
@@ -32,20 +34,20 @@ struct UnaryExpr : Expr { UnOp op; Expr* sub; explicit UnaryExpr(UnOp o, Expr* s
 	void accept(Visitor* v) override;
 };
 
-struct CallExpr : Expr { std::string callee; std::vector<Expr*> args;
+struct CallExpr : Expr { Symbol callee; ArenaVector<Expr*> args;
 	void accept(Visitor* v) override;
 };
 
-// ---  ---
+// --- 语句 ---
 struct Stmt : Node {
 };
 struct ExprStmt : Stmt { Expr* e; explicit ExprStmt(Expr* x) : e(x) {} 
 	void accept(Visitor* v) override;
 };
-struct AssignStmt : Stmt { std::string name; Expr* rhs; AssignStmt(std::string n, Expr* r) : name(std::move(n)), rhs(r) {} 
+struct AssignStmt : Stmt { Symbol name; Expr* rhs; AssignStmt(Symbol n, Expr* r) : name(n), rhs(r) {} 
 	void accept(Visitor* v) override;
 };
-struct DeclStmt : Stmt { std::string name; Expr* init; DeclStmt(std::string n, Expr* i) : name(std::move(n)), init(i) {} 
+struct DeclStmt : Stmt { Symbol name; Expr* init; DeclStmt(Symbol n, Expr* i) : name(n), init(i) {} 
 	void accept(Visitor* v) override;
 };
 struct ReturnStmt : Stmt { Expr* e; explicit ReturnStmt(Expr* x) : e(x) {} 
@@ -57,7 +59,7 @@ struct BreakStmt : Stmt {
 struct ContinueStmt : Stmt {
 	void accept(Visitor* v) override;
 };
-struct Block : Stmt { std::vector<Stmt*> stmts; 
+struct Block : Stmt { ArenaVector<Stmt*> stmts; 
 	void accept(Visitor* v) override;
 };
 struct IfStmt : Stmt {
@@ -73,35 +75,30 @@ struct WhileStmt : Stmt {
 };
 
 
-// --- / ---
-struct Param : Node { TypeKind type_val; std::string name; 
+// --- 函数/程序 ---
+struct Param : Node { TypeKind type_val; Symbol name; 
 	void accept(Visitor* v) override;
 };
 struct FuncDef : Node {
-	TypeKind ret; std::string name; std::vector<Param*> params; Block* body;
+	TypeKind ret; Symbol name; ArenaVector<Param*> params; Block* body;
 	void accept(Visitor* v) override;
 };
-struct Program : Node { std::vector<FuncDef*> funcs; 
+struct Program : Node { ArenaVector<FuncDef*> funcs; 
 	void accept(Visitor* v) override;
 };
 
-// ѡһ򵥵ġء
-extern std::vector<std::unique_ptr<Node>> g_arena;
-template<class T, class...Args>
-T* arena_make(Args&&...args) {
-	auto p = std::make_unique<T>(std::forward<Args>(args)...);
-	T* raw = p.get(); g_arena.emplace_back(std::move(p)); return raw;
-}
+// 所有节点都由语法分析器在本次编译的 Arena 里创建（arena.make<T>(...)），随 Arena 整体释放，
+// 不会逐个析构：节点里只放指针、Symbol 和 ArenaVector 这类不需要析构的成员
 class Visitor {
 public:
 	virtual ~Visitor() = default;
-	// Ϊÿһ AST ڵһ visit 
-	// 뺯
+	// 为你的每一个 AST 节点类添加一个 visit 方法
+	// 程序与函数
 	virtual void visit(Program* node) = 0;
 	virtual void visit(FuncDef* node) = 0;
 	virtual void visit(Param* node) = 0;
 
-	// 
+	// 语句
 	virtual void visit(Block* node) = 0;
 	virtual void visit(ExprStmt* node) = 0;
 	virtual void visit(AssignStmt* node) = 0;
@@ -112,7 +109,7 @@ public:
 	virtual void visit(IfStmt* node) = 0;
 	virtual void visit(WhileStmt* node) = 0;
 
-	// ʽ
+	// 表达式
 	virtual void visit(IntLiteral* node) = 0;
 	virtual void visit(VarExpr* node) = 0;
 	virtual void visit(BinaryExpr* node) = 0;
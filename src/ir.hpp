@@ -1,78 +1,202 @@
 //ir.hpp
-//ݽṹ
+//定义数据结构
 // src/ir.hpp
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "ast.hpp"
-//  ast.hpp ֻΪʹ TypeKind ö٣
-// õ ir.hpp ҲһݣԱֺ˺ǰ˵Ľ
+#include "Symbol.hpp"
+// 引入 ast.hpp 只是为了使用 TypeKind 枚举，
+// 更好的做法是在 ir.hpp 中也定义一份，以保持后端和前端的解耦。
 // 
-// Ǿʱǩ
+// 操作数：可以是具名变量、临时变量、常量或标签
+// 名字是驻留的 Symbol，整个结构是可以随意按值复制的 POD
 struct Operand {
-    enum Kind { VAR, TEMP, CONST, LABEL, NONE};
+    enum Kind : uint8_t { VAR, TEMP, CONST, LABEL, NONE};
     Kind kind = NONE;
-    std::string name; //  VAR
-    int id;           //  TEMP  LABEL
-    int value;        //  CONST
+    Symbol name;      // 用于 VAR 和 LABEL（函数名、块标签）
+    int id = 0;       // 用于 TEMP 和 LABEL
+    int value = 0;    // 用于 CONST
 };
 
-// ַָ
-// ַָ
+// 三地址码指令
+// 三地址码指令
 struct Instruction {
     enum OpCode {
-        // 
+        // 算术运算
         ADD, SUB, MUL, DIV, MOD,
 
-        // ߼ϵ
-        NOT, // һԪ߼ !
-        EQ,  //  ==
-        NEQ, //  !=
-        LT,  // С <
-        GT,  //  >
-        LE,  // Сڵ <=
-        GE,  // ڵ >=
+        // 逻辑与关系运算
+        NOT, // 一元逻辑非 !
+        EQ,  // 等于 ==
+        NEQ, // 不等于 !=
+        LT,  // 小于 <
+        GT,  // 大于 >
+        LE,  // 小于等于 <=
+        GE,  // 大于等于 >=
 
-        // ֵ
+        // 赋值
         ASSIGN,
 
-        // 
-        PARAM,//ݲ
+        // 函数
+        PARAM,//传递参数
         CALL,
         RET,
+        TAIL_CALL,      // 尾调用：复用当前栈帧跳到 arg1，被调用者直接返回到我们的调用者
 
-        // ֧ǩ
-        JUMP,           // ת
-        JUMP_IF_ZERO,   //  arg1 ֵΪ 0 ת
-        JUMP_IF_NZERO,  //  arg1 ֵΪ 0 ת
-        LABEL
+        // 分支与标签
+        JUMP,           // 无条件跳转
+        JUMP_IF_ZERO,   // 如果 arg1 的值为 0 则跳转
+        JUMP_IF_NZERO,  // 如果 arg1 的值不为 0 则跳转
+        LABEL,
+
+        // SSA
+        PHI             // result = phi(phi_args)，只出现在块的开头
+    };
+
+    // PHI 的一个入边：从标签为 block 的前驱块进入时取 value
+    // value 为 NONE 表示这条路径上变量未定义
+    struct PhiArg {
+        Symbol block;
+        Operand value;
     };
 
     OpCode opcode;
     Operand result;
     Operand arg1;
     Operand arg2;
+    std::vector<PhiArg> phi_args; // 仅用于 PHI
 };
 
+// --- 指令的定值/使用查询（供活跃分析、寄存器分配和优化遍使用）---
+// 只有 VAR 和 TEMP 算“值”；CALL 的 arg1 是函数名，跳转的目标是标签，都不算使用。
+inline bool is_value(const Operand& op) {
+    return op.kind == Operand::VAR || op.kind == Operand::TEMP;
+}
+
+// 值的整数键，可以直接当哈希表的键：VAR 用名字的编号，TEMP 用临时变量编号，两者用高 32 位区分
+using ValueKey = uint64_t;
+inline ValueKey value_key(const Operand& op) {
+    return op.kind == Operand::VAR ? (uint64_t(1) << 32) | op.name.id() : (uint64_t(2) << 32) | uint32_t(op.id);
+}
+
+// 两个操作数是否指代同一个变量/临时变量
+inline bool same_value(const Operand& a, const Operand& b) {
+    if (a.kind != b.kind) return false;
+    if (a.kind == Operand::VAR) return a.name == b.name;
+    if (a.kind == Operand::TEMP) return a.id == b.id;
+    return false;
+}
+
+// 指令定义的值，没有则返回 nullptr
+inline Operand* instr_def(Instruction& instr) {
+    switch (instr.opcode) {
+    case Instruction::PARAM: case Instruction::RET: case Instruction::TAIL_CALL: case Instruction::JUMP:
+    case Instruction::JUMP_IF_ZERO: case Instruction::JUMP_IF_NZERO: case Instruction::LABEL:
+        return nullptr;
+    default:
+        return is_value(instr.result) ? &instr.result : nullptr;
+    }
+}
+inline const Operand* instr_def(const Instruction& instr) {
+    return instr_def(const_cast<Instruction&>(instr));
+}
+
+// 对指令使用的每个值调用 f(Operand&)
+// PHI 的实参实际上是在对应前驱块的末尾使用的，需要区分边的分析要自己处理 PHI
+template<class F>
+void for_each_use(Instruction& instr, F f) {
+    switch (instr.opcode) {
+    case Instruction::CALL: case Instruction::TAIL_CALL: case Instruction::JUMP: case Instruction::LABEL:
+        return;
+    case Instruction::PHI:
+        for (auto& arg : instr.phi_args) {
+            if (is_value(arg.value)) f(arg.value);
+        }
+        return;
+    case Instruction::NOT: case Instruction::ASSIGN: case Instruction::PARAM:
+    case Instruction::RET: case Instruction::JUMP_IF_ZERO: case Instruction::JUMP_IF_NZERO:
+        if (is_value(instr.arg1)) f(instr.arg1);
+        return;
+    default:
+        if (is_value(instr.arg1)) f(instr.arg1);
+        if (is_value(instr.arg2)) f(instr.arg2);
+        return;
+    }
+}
+template<class F>
+void for_each_use(const Instruction& instr, F f) {
+    for_each_use(const_cast<Instruction&>(instr), [&](Operand& op) { f(static_cast<const Operand&>(op)); });
+}
+
+// 跳转指令的目标标签名；不是跳转则返回 nullptr
+inline const Symbol* jump_target(const Instruction& instr) {
+    if (instr.opcode == Instruction::JUMP) return &instr.arg1.name;
+    if (instr.opcode == Instruction::JUMP_IF_ZERO || instr.opcode == Instruction::JUMP_IF_NZERO) return &instr.arg2.name;
+    return nullptr;
+}
+
+// 离开函数的指令：RET 和尾调用
+inline bool is_return(const Instruction& instr) {
+    return instr.opcode == Instruction::RET || instr.opcode == Instruction::TAIL_CALL;
+}
+
+// 无条件跳转和 RET（含尾调用）之后的指令永远不会执行
+inline bool is_terminator(const Instruction& instr) {
+    return instr.opcode == Instruction::JUMP || is_return(instr);
+}
+
 struct ParamInfo {
-    std::string name;
-    TypeKind TY_INT; // ʱ intΪδչ
+    Symbol name;
+    TypeKind TY_INT; // 暂时都是 int，为未来扩展保留
 };
 
-//  (Basic Block)
+// 基本块 (Basic Block)
 struct BasicBlock {
-    std::string label;
+    Symbol label;
     std::vector<Instruction> instructions;
+
+    // --- 控制流图的边（由 build_cfg 计算）---
+    int id = -1;             // 块在 FunctionIR::blocks 中的下标
+    std::vector<int> preds;  // 前驱块 id
+    std::vector<int> succs;  // 后继块 id
 };
 
-//  IR ʾ
+// 控制流图的全局信息（由 build_cfg 计算）
+// 入口块总是 blocks[0]；不可达的块不出现在 rpo 中，其 idom 为 -1
+struct CFGInfo {
+    std::vector<int> rpo;                      // 逆后序
+    std::vector<int> rpo_index;                // 块 id -> 在 rpo 中的序号，不可达为 -1
+    std::vector<int> idom;                     // 直接支配者，入口块的 idom 是它自己
+    std::vector<std::vector<int>> dom_children; // 支配树的孩子
+    std::vector<int> dom_pre, dom_post;        // 支配树的先序/后序编号，用于 O(1) 支配查询
+    std::vector<int> exits;                    // 以 RET/尾调用结束的块
+    std::unordered_map<Symbol, int> label_index; // 标签 -> 块 id
+};
+
+// 函数的 IR 表示
 struct FunctionIR {
-    std::string name;
+    Symbol name;
     std::vector<ParamInfo> params;
     std::vector<BasicBlock> blocks;
+    CFGInfo cfg;
+
+    bool in_ssa = false;   // 是否处于 SSA 形式（代码生成前必须消去）
+    int next_temp = 0;     // 优化遍新建临时变量的编号，大于函数中已有的所有 TEMP id
+    int next_label = 0;    // 优化遍新建块标签的计数器
 };
 
-//  IR
+// 为优化遍创建一个函数内唯一的新临时变量
+inline Operand make_temp(FunctionIR& func) {
+    Operand op;
+    op.kind = Operand::TEMP;
+    op.id = func.next_temp++;
+    return op;
+}
+
+// 整个程序的 IR
 struct ModuleIR {
     std::vector<FunctionIR> functions;
 };
\ No newline at end of file
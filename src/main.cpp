@@ -5,33 +5,28 @@
 #include <vector>
 
 #include "ast.hpp"
+#include "CompilationContext.hpp"
 #include "SemanticAnalyzer.hpp"
 #include "IRGenerator.hpp"
+#include "Optimizer.hpp"
 #include "CodeGenerator.hpp"    
 
-// --- ⲿļӵȫֱͺ ---
-extern FILE* yyin;
-extern Program* g_root;
-extern int yyparse(void);
-extern int yydebug;
-extern int yy_flex_debug;
+// --- 辅助函数，用于将 IR 打印到控制台，方便调试 ---
 
-// --- ڽ IR ӡ̨ ---
-
-//  Operand ṹתΪɶַ
+// 将 Operand 结构体转换为可读字符串
 std::string operand_to_string(const Operand& op) {
     switch (op.kind) {
-    case Operand::VAR:   return op.name;
+    case Operand::VAR:   return op.name.str();
     case Operand::TEMP:  return "t" + std::to_string(op.id);
     case Operand::CONST: return std::to_string(op.value);
     case Operand::LABEL:
-        // ǩ֣纯ڣ֣ID
-        return op.name.empty() ? ".L" + std::to_string(op.id) : op.name;
+        // 如果标签有名字（如函数入口），用名字；否则用ID
+        return op.name.empty() ? ".L" + std::to_string(op.id) : op.name.str();
     default: return "??";
     }
 }
 
-// ӡģ IR
+// 打印整个模块的 IR
 void print_ir(const ModuleIR& module) {
     for (const auto& func : module.functions) {
         std::cout << "FUNCTION " << func.name << ":" << std::endl;
@@ -40,7 +35,7 @@ void print_ir(const ModuleIR& module) {
             for (const auto& instr : block.instructions) {
                 std::cout << "  ";
                 switch (instr.opcode) {
-                    // ---  ---
+                    // --- 算术运算 ---
                 case Instruction::ADD:
                     std::cout << operand_to_string(instr.result) << " = " << operand_to_string(instr.arg1) << " + " << operand_to_string(instr.arg2);
                     break;
@@ -57,7 +52,7 @@ void print_ir(const ModuleIR& module) {
                     std::cout << operand_to_string(instr.result) << " = " << operand_to_string(instr.arg1) << " % " << operand_to_string(instr.arg2);
                     break;
 
-                    // --- ߼ϵ ---
+                    // --- 逻辑与关系运算 ---
                 case Instruction::NOT:
                     std::cout << operand_to_string(instr.result) << " = NOT " << operand_to_string(instr.arg1);
                     break;
@@ -80,25 +75,28 @@ void print_ir(const ModuleIR& module) {
                     std::cout << operand_to_string(instr.result) << " = " << operand_to_string(instr.arg1) << " >= " << operand_to_string(instr.arg2);
                     break;
 
-                    // --- ֵ ---
+                    // --- 赋值 ---
                 case Instruction::ASSIGN:
                     std::cout << operand_to_string(instr.result) << " = " << operand_to_string(instr.arg1);
                     break;
 
                 
-                // ---  ---
-                case Instruction::PARAM: // <-- 
+                // --- 函数 ---
+                case Instruction::PARAM: // <-- 新增
                     std::cout << "PARAM " << operand_to_string(instr.arg1);
                     break;
                 case Instruction::CALL:
-                    // Ҳӡ
+                    // 现在也打印参数数量
                     std::cout << operand_to_string(instr.result) << " = CALL " << operand_to_string(instr.arg1) << ", " << operand_to_string(instr.arg2);
                     break;
                 case Instruction::RET:
                     std::cout << "RET " << (instr.arg1.kind != Operand::NONE ? operand_to_string(instr.arg1) : "");
                     break;
+                case Instruction::TAIL_CALL:
+                    std::cout << "TAIL CALL " << operand_to_string(instr.arg1) << ", " << operand_to_string(instr.arg2);
+                    break;
 
-                    // --- ֧ǩ ---
+                    // --- 分支与标签 ---
                 case Instruction::JUMP:
                     std::cout << "JUMP " << operand_to_string(instr.arg1);
                     break;
@@ -109,8 +107,17 @@ void print_ir(const ModuleIR& module) {
                     std::cout << "IF " << operand_to_string(instr.arg1) << " != 0 JUMP " << operand_to_string(instr.arg2);
                     break;
                 case Instruction::LABEL:
-                    // ǩǿ֣ͨҪΪָӡ
-                    continue; // ӡ
+                    // 标签本身就是块的名字，通常不需要作为指令打印
+                    continue; // 跳过打印
+
+                    // --- SSA ---
+                case Instruction::PHI:
+                    std::cout << operand_to_string(instr.result) << " = PHI";
+                    for (size_t i = 0; i < instr.phi_args.size(); ++i) {
+                        std::cout << (i == 0 ? " " : ", ") << "[" << operand_to_string(instr.phi_args[i].value)
+                            << ", " << instr.phi_args[i].block << "]";
+                    }
+                    break;
                 }
                 std::cout << std::endl;
             }
@@ -119,48 +126,120 @@ void print_ir(const ModuleIR& module) {
     }
 }
 
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [-O0|-O1|-O2] [-regalloc=spill|linear|graph] [-sched=none|pre|post|both] [-sched-model=file] [-time-passes] [file]" << std::endl;
+}
+
 int main(int argc, char** argv) {
-    if (argc > 1) {
-        yyin = fopen(argv[1], "r");
-        if (!yyin) {
-            perror("Error opening file");
+    // --- 命令行参数 ---
+    OptLevel opt_level = OptLevel::O1;
+    bool time_passes = false;
+    std::string regalloc; // 为空时由优化级别决定
+    std::string sched;    // 为空时由优化级别决定
+    SchedModel sched_model;
+    const char* input_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-O0") opt_level = OptLevel::O0;
+        else if (arg == "-O1") opt_level = OptLevel::O1;
+        else if (arg == "-O2") opt_level = OptLevel::O2;
+        else if (arg == "-time-passes") time_passes = true;
+        else if (arg == "-regalloc=spill" || arg == "-regalloc=linear" || arg == "-regalloc=graph") {
+            regalloc = arg.substr(std::string("-regalloc=").size());
+        }
+        else if (arg == "-sched=none" || arg == "-sched=pre" || arg == "-sched=post" || arg == "-sched=both") {
+            sched = arg.substr(std::string("-sched=").size());
+        }
+        else if (arg.compare(0, 13, "-sched-model=") == 0) {
+            std::string error;
+            if (!sched_model.loadFile(arg.substr(13), error)) {
+                std::cerr << "Error reading scheduling model: " << error << std::endl;
+                return 1;
+            }
+        }
+        else if (!arg.empty() && arg[0] == '-') {
+            print_usage(argv[0]);
             return 1;
         }
+        else input_path = argv[i];
     }
 
-    // yydebug = 1;
-    // yy_flex_debug = 1;
+    FILE* input = stdin;
+    if (input_path) {
+        input = fopen(input_path, "r");
+        if (!input) {
+            perror("Error opening file");
+            return 1;
+        }
+    }
 
-    int parse_result = yyparse();
+    // 这次编译的状态：符号表、AST 所在的 arena、语法树根和诊断，生成 IR 之后就释放 AST
+    CompilationContext ctx;
+    const bool parsed = ctx.parse(input);
+    if (input != stdin) {
+        fclose(input);
+    }
 
-    if (parse_result == 0 && g_root != nullptr) {
+    if (parsed) {
         std::cout << "\nParsing successful! AST created." << std::endl;
 
-        SemanticAnalyzer analyzer;
-        analyzer.analyze(g_root);
+        SemanticAnalyzer analyzer(ctx);
+        analyzer.analyze(ctx.root());
         std::cout << "Semantic analysis finished." << std::endl;
+        // 词法错误（跳过的字符）和语义错误不妨碍建树，但有任何一条诊断就不再往下编译
+        if (!ctx.diagnostics().empty()) {
+            ctx.printDiagnostics(std::cerr);
+            std::cout << "\nCompilation failed." << std::endl;
+            return 1;
+        }
 
         std::cout << "\n--- Starting IR Generation ---" << std::endl;
         IRGenerator ir_gen;
-        ModuleIR ir_module = ir_gen.generate(g_root);
+        ModuleIR ir_module = ir_gen.generate(ctx.root());
         std::cout << "--- IR Generation Finished ---" << std::endl;
+        ctx.releaseAst();
 
         std::cout << "\n--- Generated Intermediate Representation ---" << std::endl;
         print_ir(ir_module);
-        CodeGenerator code_gen;
+
+        Optimizer optimizer(opt_level);
+        if (optimizer.run(ir_module)) {
+            std::cout << "\n--- Optimized Intermediate Representation ---" << std::endl;
+            print_ir(ir_module);
+        }
+        if (time_passes) {
+            optimizer.printStats(std::cerr);
+        }
+
+        // 优化级别同时决定寄存器分配策略：越高越慢，生成的代码越好
+        AllocatorKind allocator = AllocatorKind::SpillEverything;
+        if (opt_level == OptLevel::O1) allocator = AllocatorKind::LinearScan;
+        if (opt_level == OptLevel::O2) allocator = AllocatorKind::GraphColoring;
+        if (regalloc == "spill") allocator = AllocatorKind::SpillEverything;
+        if (regalloc == "linear") allocator = AllocatorKind::LinearScan;
+        if (regalloc == "graph") allocator = AllocatorKind::GraphColoring;
+        CodeGenerator code_gen(allocator);
+        code_gen.setPeephole(opt_level != OptLevel::O0);
+        code_gen.setStrengthReduction(opt_level != OptLevel::O0);
+        // 调度默认在 -O1 以上打开，分配前后各一次
+        if (sched.empty()) sched = opt_level == OptLevel::O0 ? "none" : "both";
+        code_gen.setScheduling(sched == "pre" || sched == "both", sched == "post" || sched == "both", sched_model);
         std::string assembly_code = code_gen.generate(ir_module);
+        if (time_passes && opt_level != OptLevel::O0) {
+            code_gen.peephole().printStats(std::cerr);
+        }
+        if (time_passes && sched != "none") {
+            code_gen.scheduler().printStats(std::cerr);
+        }
 
-        // --- ޸ġ׼ ---
+        // --- 【核心修改】将汇编代码输出到标准输出流 ---
         std::cout << assembly_code;
 
     }
     else {
+        ctx.printDiagnostics(std::cerr);
         std::cout << "\nParsing failed." << std::endl;
     }
 
-    if (yyin) {
-        fclose(yyin);
-    }
-
-    return parse_result;
+    return parsed ? 0 : 1;
 }
@@ -1,26 +1,46 @@
 %code requires {
 
-  #include "ast.hpp" // ast.hpp  AST ڵ㲢 <vector>
+  #include "ast.hpp" // ast.hpp 定义了 AST 节点并包含了 <vector>
+  class CompilationContext;
+  // 可重入扫描器的句柄，与 Flex 生成的定义相同
+  #ifndef YY_TYPEDEF_YY_SCANNER_T
+  #define YY_TYPEDEF_YY_SCANNER_T
+  typedef void* yyscan_t;
+  #endif
 }
-%{ 
-  // C/C++ ͷļȫ
-  #include <cstdio>
-  // yylex  lexer.l 
-  int yylex(void);        /* ɣ extern "C" */
-  extern FILE* yyin;
-
-  //Program* g_root = nullptr;
-  extern int yylineno;
-  void yyerror(const char *s) {
-    std::fprintf(stderr, "Parse error at line %d: %s\n", yylineno, s);
+%code {
+  // C/C++ 头文件与声明
+  #include <string>
+  #include <utility>
+  #include "CompilationContext.hpp"
+  // yylex/yyget_lineno 由 lexer.l 生成（reentrant + bison-bridge）
+  int yylex(YYSTYPE* yylval_param, yyscan_t yyscanner);
+  int yyget_lineno(yyscan_t yyscanner);
+
+  void yyerror(yyscan_t scanner, CompilationContext& ctx, const char *s) {
+    ctx.error("Parse", yyget_lineno(scanner), s);
   }
-%}
 
-/* token Ҫ lexer.l  return  TOKEN һһӦ */
-/*  yylval Դַָ */
+  // 在 arena 里创建 AST 节点，并记下当前行号
+  template<class T, class... Args>
+  T* make_node(yyscan_t scanner, CompilationContext& ctx, Args&&... args) {
+    T* node = ctx.arena().make<T>(std::forward<Args>(args)...);
+    node->line = yyget_lineno(scanner);
+    return node;
+  }
+}
+
+/* 可重入：没有全局的 yylval/yyin/g_root，扫描器和编译上下文都由调用者传进来，
+   即 yyparse(scanner, ctx)；节点分配在 ctx.arena() 里，语法树根交给 ctx.setRoot */
+%define api.pure full
+%lex-param { yyscan_t scanner }
+%parse-param { yyscan_t scanner } { CompilationContext& ctx }
+
+/* token 声明：要和 lexer.l 中 return 的 TOKEN 一一对应 */
+/* 定义 yylval 可以存整数或标识符（驻留后的 Symbol 编号） */
 %union {
    int                    intval;
-  char*                  strval;
+  unsigned               symval;
 
   TypeKind               type_val;
 
@@ -31,15 +51,15 @@
   Param*                 param;
   Program*               program;
 
-  std::vector<Stmt*>*        stmts;
-  std::vector<Expr*>*        args;
-  std::vector<Param*>*       params;
-  std::vector<FuncDef*>*     funcs;
+  ArenaVector<Stmt*>*        stmts;
+  ArenaVector<Expr*>*        args;
+  ArenaVector<Param*>*       params;
+  ArenaVector<FuncDef*>*     funcs;
 }
 
-/*  Bisonͬ token Ӧ union еĸԱ */
+/* 告诉 Bison：不同的 token 对应 union 中的哪个成员 */
 %token <intval>    NUMBER
-%token <strval>    IDENTIFIER
+%token <symval>    IDENTIFIER
 %token              PLUS MINUS MULTIPLY DIVIDE PERCENT
 %token              EXCLAPOINT EQ NEQ LE GE LT GT OR AND
 %token              ASSIGN
@@ -52,7 +72,7 @@
 %nonassoc LOWER_THAN_ELSE   
 %nonassoc ELSE              
 
-/* -------------------- ս -------------------- */
+/* -------------------- 非终结符类型 -------------------- */
 %type <program> program
 %type <funcs>   FuncDef_list
 %type <func>    FuncDef
@@ -68,37 +88,35 @@
 %type <expr>    expression LOrexpr LAndexpr Relexpr Addexpr Mulexpr Unaryexpr Primaryexpr
 %type <args>    expr_list expr_list_opt
 
-/* -------------------- ʱͷмֵ -------------------- */
-%destructor { free($$); } <strval>
-%destructor { delete $$; } <stmts> <args> <params> <funcs>
+/* 中间的列表和节点都在 arena 里，出错回溯时不用逐个释放，随 arena 一起归还 */
 /*%%
-  һ %% ֮ǰʡԣ
-  ڶ %% ֮ǰǹ
-  һ %% ֮ C/C++ ӳ 
+  第一对 %% 之前是声明区（可以省略），
+  第二对 %% 之前是规则区，
+  最后一个 %% 之后是 C/C++ 子程序区 
 %%*/
 
-/* */
+/* 规则区*/
 %%
 program:
       FuncDef_list
       {
-      Program* p = arena_make<Program>();
-      if ($1) { p->funcs.swap(*$1); delete $1; }
+      Program* p = make_node<Program>(scanner, ctx);
+      p->funcs = *$1;
       $$ = p;
-      g_root = p;
+      ctx.setRoot(p);
     }
    ;
 
 FuncDef_list:
       FuncDef
       {
-      $$ = new std::vector<FuncDef*>();
-      $$->push_back($1);
+      $$ = ctx.arena().make<ArenaVector<FuncDef*>>();
+      $$->push_back(ctx.arena(), $1);
     }
     | FuncDef_list FuncDef 
     {
-      $$ = $1;//$$ΪFuncDefԼõFuncDef_list
-      $$->push_back($2);//ѹ
+      $$ = $1;//$$为最左的FuncDef规约得到的FuncDef_list
+      $$->push_back(ctx.arena(), $2);//压入
     }
     ;
 
@@ -106,47 +124,43 @@ FuncDef_list:
 statement:
        Block{ $$ = $1; }
      | SEMI { $$ = nullptr; }
-     | expression SEMI { $$ = arena_make<ExprStmt>($1); }
+     | expression SEMI { $$ = make_node<ExprStmt>(scanner, ctx, $1); }
      | IDENTIFIER ASSIGN expression SEMI{
-      $$ = arena_make<AssignStmt>(std::string($1), $3);
-      free($1);
+      $$ = make_node<AssignStmt>(scanner, ctx, Symbol::fromId($1), $3);
     }
      | INT IDENTIFIER ASSIGN expression SEMI
      {
-      /* ֲ͹̶Ϊ int */
-      $$ = arena_make<DeclStmt>(std::string($2), $4); free($2);
+      /* 局部变量类型固定为 int */
+      $$ = make_node<DeclStmt>(scanner, ctx, Symbol::fromId($2), $4);
     }
      | IF LPAREN expression RPAREN statement  %prec LOWER_THAN_ELSE
      {
-      $$ = arena_make<IfStmt>($3, $5, nullptr);
+      $$ = make_node<IfStmt>(scanner, ctx, $3, $5, nullptr);
     }
      | IF LPAREN expression RPAREN statement ELSE statement
      {
-      $$ = arena_make<IfStmt>($3, $5, $7);
+      $$ = make_node<IfStmt>(scanner, ctx, $3, $5, $7);
     }
      | WHILE LPAREN expression RPAREN statement 
      {
-      $$ = arena_make<WhileStmt>($3, $5);
+      $$ = make_node<WhileStmt>(scanner, ctx, $3, $5);
     }
      | BREAK SEMI
-      { $$ = arena_make<BreakStmt>(); }
-     | CONTINUE SEMI { $$ = arena_make<ContinueStmt>(); }
-     | RETURN SEMI { $$ = arena_make<ReturnStmt>(nullptr); }
-     | RETURN expression SEMI  { $$ = arena_make<ReturnStmt>($2); }
+      { $$ = make_node<BreakStmt>(scanner, ctx); }
+     | CONTINUE SEMI { $$ = make_node<ContinueStmt>(scanner, ctx); }
+     | RETURN SEMI { $$ = make_node<ReturnStmt>(scanner, ctx, nullptr); }
+     | RETURN expression SEMI  { $$ = make_node<ReturnStmt>(scanner, ctx, $2); }
    ;
 statement_list:
-    /**/{ $$ = new std::vector<Stmt*>(); }
-    | statement_list statement{ $$ = $1; if ($2) $$->push_back($2); }
+    /*ε*/{ $$ = ctx.arena().make<ArenaVector<Stmt*>>(); }
+    | statement_list statement{ $$ = $1; if ($2) $$->push_back(ctx.arena(), $2); }
     ;
 
 Block:
       LBRACE statement_list RBRACE
       {
-      Block* b = arena_make<Block>();
-      if ($2) {
-        for (auto* s : *$2) if (s) b->stmts.push_back(s);
-        delete $2;
-      }
+      Block* b = make_node<Block>(scanner, ctx);
+      b->stmts = *$2; // statement_list 已经滤掉了空语句
       $$ = b;
     }
     ;
@@ -155,10 +169,10 @@ Block:
 FuncDef:
       return_type IDENTIFIER LPAREN param_list_opt RPAREN Block
       {
-      FuncDef* f = arena_make<FuncDef>();
+      FuncDef* f = make_node<FuncDef>(scanner, ctx);
       f->ret = $1;
-      f->name = std::string($2); free($2);
-      if ($4) { f->params.swap(*$4); delete $4; }
+      f->name = Symbol::fromId($2);
+      f->params = *$4;
       f->body = $6;
       $$ = f;
     }
@@ -170,7 +184,7 @@ return_type:
     ;
 
 param_list_opt:
-      /**/{ $$ = new std::vector<Param*>(); }
+      /*ε*/{ $$ = ctx.arena().make<ArenaVector<Param*>>(); }
     | param_list{ $$ = $1; }
     ;
 
@@ -178,21 +192,21 @@ param_list:
       param_list COMMA param
       {
       $$ = $1;
-      $$->push_back($3);
+      $$->push_back(ctx.arena(), $3);
     }
     | param
     {
-      $$ = new std::vector<Param*>();
-      $$->push_back($1);
+      $$ = ctx.arena().make<ArenaVector<Param*>>();
+      $$->push_back(ctx.arena(), $1);
     }
     ;
 
 param:
       INT IDENTIFIER
       {
-      Param* p = arena_make<Param>();
+      Param* p = make_node<Param>(scanner, ctx);
       p->type_val = TypeKind::TY_INT;
-      p->name = std::string($2); free($2);
+      p->name = Symbol::fromId($2);
       $$ = p;
     }
     ;
@@ -203,53 +217,53 @@ expression:
 
 LOrexpr:
       LAndexpr { $$ = $1; }
-    | LOrexpr OR LAndexpr{ $$ = arena_make<BinaryExpr>(BinOp::LOr,  $1, $3); }
+    | LOrexpr OR LAndexpr{ $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::LOr,  $1, $3); }
     ;
 
 LAndexpr:
       Relexpr{ $$ = $1; }
-    | LAndexpr AND Relexpr{ $$ = arena_make<BinaryExpr>(BinOp::LAnd, $1, $3); }
+    | LAndexpr AND Relexpr{ $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::LAnd, $1, $3); }
     ;
 
 Relexpr:
       Addexpr{ $$ = $1; }   
-    | Relexpr LT Addexpr { $$ = arena_make<BinaryExpr>(BinOp::Lt,  $1, $3); }
-    | Relexpr GT Addexpr { $$ = arena_make<BinaryExpr>(BinOp::Gt,  $1, $3); }
-    | Relexpr LE Addexpr { $$ = arena_make<BinaryExpr>(BinOp::Le,  $1, $3); }
-    | Relexpr GE Addexpr { $$ = arena_make<BinaryExpr>(BinOp::Ge,  $1, $3); }
-    | Relexpr EQ Addexpr { $$ = arena_make<BinaryExpr>(BinOp::Eq,  $1, $3); }
-    | Relexpr NEQ Addexpr { $$ = arena_make<BinaryExpr>(BinOp::Neq, $1, $3); }
+    | Relexpr LT Addexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Lt,  $1, $3); }
+    | Relexpr GT Addexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Gt,  $1, $3); }
+    | Relexpr LE Addexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Le,  $1, $3); }
+    | Relexpr GE Addexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Ge,  $1, $3); }
+    | Relexpr EQ Addexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Eq,  $1, $3); }
+    | Relexpr NEQ Addexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Neq, $1, $3); }
     ;
 
 Addexpr:
       Mulexpr{ $$ = $1; }
-    | Addexpr PLUS Mulexpr{ $$ = arena_make<BinaryExpr>(BinOp::Add, $1, $3); }
-    | Addexpr MINUS Mulexpr{ $$ = arena_make<BinaryExpr>(BinOp::Sub, $1, $3); }
+    | Addexpr PLUS Mulexpr{ $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Add, $1, $3); }
+    | Addexpr MINUS Mulexpr{ $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Sub, $1, $3); }
     ; 
 
 Mulexpr:
       Unaryexpr{ $$ = $1; }
-    | Mulexpr MULTIPLY Unaryexpr { $$ = arena_make<BinaryExpr>(BinOp::Mul, $1, $3); }
-    | Mulexpr DIVIDE Unaryexpr { $$ = arena_make<BinaryExpr>(BinOp::Div, $1, $3); }
-    | Mulexpr PERCENT Unaryexpr { $$ = arena_make<BinaryExpr>(BinOp::Mod, $1, $3); }
+    | Mulexpr MULTIPLY Unaryexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Mul, $1, $3); }
+    | Mulexpr DIVIDE Unaryexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Div, $1, $3); }
+    | Mulexpr PERCENT Unaryexpr { $$ = make_node<BinaryExpr>(scanner, ctx, BinOp::Mod, $1, $3); }
     ;
 
 Unaryexpr:
       Primaryexpr { $$ = $1; }
-    | PLUS Unaryexpr { $$ = arena_make<UnaryExpr>(UnOp::Pos, $2); }
-    | MINUS Unaryexpr { $$ = arena_make<UnaryExpr>(UnOp::Neg, $2); }
-    | EXCLAPOINT Unaryexpr { $$ = arena_make<UnaryExpr>(UnOp::Not, $2); }
+    | PLUS Unaryexpr { $$ = make_node<UnaryExpr>(scanner, ctx, UnOp::Pos, $2); }
+    | MINUS Unaryexpr { $$ = make_node<UnaryExpr>(scanner, ctx, UnOp::Neg, $2); }
+    | EXCLAPOINT Unaryexpr { $$ = make_node<UnaryExpr>(scanner, ctx, UnOp::Not, $2); }
     ;
 
 Primaryexpr:
       IDENTIFIER
       {
-      $$ = arena_make<VarExpr>(std::string($1)); free($1);
+      $$ = make_node<VarExpr>(scanner, ctx, Symbol::fromId($1));
     }
 
     | NUMBER
     {
-      $$ = arena_make<IntLiteral>($1);
+      $$ = make_node<IntLiteral>(scanner, ctx, $1);
     }
     | LPAREN expression RPAREN
     {
@@ -257,15 +271,15 @@ Primaryexpr:
     }
     | IDENTIFIER LPAREN expr_list_opt RPAREN
     {
-      CallExpr* c = arena_make<CallExpr>();
-      c->callee = std::string($1); free($1);
-      if ($3) { c->args.swap(*$3); delete $3; }
+      CallExpr* c = make_node<CallExpr>(scanner, ctx);
+      c->callee = Symbol::fromId($1);
+      c->args = *$3;
       $$ = c;
     }
     ;
 
 expr_list_opt:
-      /**/{ $$ = new std::vector<Expr*>(); }
+      /*ε*/{ $$ = ctx.arena().make<ArenaVector<Expr*>>(); }
     | expr_list{ $$ = $1; }
     ;
 
@@ -273,17 +287,17 @@ expr_list:
       expr_list COMMA expression
       {
       $$ = $1;
-      $$->push_back($3);
+      $$->push_back(ctx.arena(), $3);
     }
     | expression
     {
-      $$ = new std::vector<Expr*>();
-      $$->push_back($1);
+      $$ = ctx.arena().make<ArenaVector<Expr*>>();
+      $$->push_back(ctx.arena(), $1);
     }
     ;
 %%
 
-/* ѡṩһ main  */
+/* （可选）提供一个入口 main 给单独测试用 */
 /* 
 int main() {
   return yyparse();
@@ -0,0 +1,88 @@
+// 多线程同时编译的测试
+//
+// 先在主线程里逐个编译命令行给出的源文件，记下生成的汇编；再为每个文件开一个线程同时编译，
+// 重复几轮，每次的结果都必须和单线程的一样。每次编译都有自己的 CompilationContext
+// （符号表、Arena、诊断），线程之间不应该共享任何可变状态：
+// 用 -fsanitize=thread 构建时（cmake -DCMAKE_CXX_FLAGS=-fsanitize=thread）ThreadSanitizer 会检查这一点。
+#include "CompilationContext.hpp"
+#include "SemanticAnalyzer.hpp"
+#include "IRGenerator.hpp"
+#include "Optimizer.hpp"
+#include "CodeGenerator.hpp"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 按 -O2 的配置编译一个文件，返回汇编；有任何诊断（语法、语义错误）时返回空串
+std::string compile(const std::string& path) {
+    FILE* in = fopen(path.c_str(), "r");
+    if (!in) return std::string();
+    CompilationContext ctx;
+    const bool parsed = ctx.parse(in);
+    fclose(in);
+    if (!parsed) return std::string();
+
+    SemanticAnalyzer analyzer(ctx);
+    analyzer.analyze(ctx.root());
+    if (!ctx.diagnostics().empty()) return std::string();
+    IRGenerator ir_gen;
+    ModuleIR module = ir_gen.generate(ctx.root());
+    ctx.releaseAst();
+
+    Optimizer optimizer(OptLevel::O2);
+    optimizer.run(module);
+    CodeGenerator code_gen(AllocatorKind::GraphColoring);
+    code_gen.setPeephole(true);
+    code_gen.setStrengthReduction(true);
+    SchedModel model;
+    code_gen.setScheduling(true, true, model);
+    return code_gen.generate(module);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> paths(argv + 1, argv + argc);
+    if (paths.empty()) {
+        std::cerr << "Usage: " << argv[0] << " file.tc..." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> expected;
+    for (const auto& path : paths) {
+        expected.push_back(compile(path));
+        if (expected.back().empty()) {
+            std::cerr << "FAIL " << path << ": compilation failed" << std::endl;
+            return 1;
+        }
+    }
+    // 编译结束后符号表随 CompilationContext 释放，线程上不再绑定任何表
+    if (SymbolTable::current() != nullptr) {
+        std::cerr << "FAIL symbol table still bound after compilation" << std::endl;
+        return 1;
+    }
+
+    const int rounds = 3;
+    int mismatches = 0;
+    for (int round = 0; round < rounds; ++round) {
+        std::vector<std::string> actual(paths.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            threads.emplace_back([&, i] { actual[i] = compile(paths[i]); });
+        }
+        for (auto& t : threads) t.join();
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (actual[i] != expected[i]) {
+                std::cerr << "FAIL " << paths[i] << ": round " << round << " differs from the single-threaded output" << std::endl;
+                ++mismatches;
+            }
+        }
+    }
+
+    std::cout << "concurrent compile: " << paths.size() << " files x " << rounds << " rounds, " << mismatches << " mismatches" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+// 循环强度削弱（含线性函数测试替换）的正确性测试
+//
+// 每个程序都编译两次：-O0 的 IR 和 -O2 优化后的 IR，用一个小的 IR 解释器分别执行 main，
+// 返回值必须和预期一致。运算都按 32 位回绕、除法按 RV32M 的规则，和生成的代码相同。
+// 重点是 i * k 会越过 32 位范围的循环：把 `i < n` 换成 `i*k < n*k` 在这种循环里会改变迭代次数。
+#include "CompilationContext.hpp"
+#include "SemanticAnalyzer.hpp"
+#include "IRGenerator.hpp"
+#include "Optimizer.hpp"
+#include "CFG.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 执行 ModuleIR 的解释器；出错（未知函数、步数超限等）时 ok() 变成 false
+class Interpreter {
+public:
+    explicit Interpreter(const ModuleIR& module) : m_module(module) {}
+
+    int32_t call(Symbol name, const std::vector<int32_t>& args, int depth = 0) {
+        const FunctionIR* func = nullptr;
+        for (const auto& f : m_module.functions) {
+            if (f.name == name) func = &f;
+        }
+        if (!func || depth > kMaxDepth) return fail("bad call to " + name.str());
+
+        std::unordered_map<ValueKey, int32_t> env;
+        for (size_t i = 0; i < func->params.size() && i < args.size(); ++i) {
+            env[value_key({ Operand::VAR, func->params[i].name })] = args[i];
+        }
+        auto val = [&](const Operand& op) -> int32_t {
+            if (op.kind == Operand::CONST) return op.value;
+            if (!is_value(op)) return 0;
+            auto it = env.find(value_key(op));
+            return it == env.end() ? 0 : it->second;
+        };
+
+        std::vector<int32_t> pending;
+        Symbol prev;
+        int b = 0;
+        while (m_ok && b >= 0 && b < (int)func->blocks.size()) {
+            const auto& instrs = func->blocks[b].instructions;
+            // 块入口的 PHI 同时取值
+            size_t i = 0;
+            std::vector<std::pair<ValueKey, int32_t>> phis;
+            for (; i < instrs.size() && instrs[i].opcode == Instruction::PHI; ++i) {
+                for (const auto& arg : instrs[i].phi_args) {
+                    if (arg.block == prev) phis.emplace_back(value_key(instrs[i].result), val(arg.value));
+                }
+            }
+            for (const auto& p : phis) env[p.first] = p.second;
+
+            int next = b + 1; // 没有跳转时落到下一个块
+            bool jumped = false;
+            for (; i < instrs.size() && !jumped; ++i) {
+                if (++m_steps > kMaxSteps) return fail("step limit");
+                const Instruction& instr = instrs[i];
+                const uint32_t x = (uint32_t)val(instr.arg1), y = (uint32_t)val(instr.arg2);
+                const int32_t sx = (int32_t)x, sy = (int32_t)y;
+                auto set = [&](int64_t v) { env[value_key(instr.result)] = (int32_t)(uint32_t)v; };
+                switch (instr.opcode) {
+                case Instruction::ADD: set(x + y); break;
+                case Instruction::SUB: set(x - y); break;
+                case Instruction::MUL: set(x * y); break;
+                case Instruction::DIV:
+                    set(sy == 0 ? -1 : (sx == INT32_MIN && sy == -1) ? INT32_MIN : sx / sy);
+                    break;
+                case Instruction::MOD:
+                    set(sy == 0 ? sx : (sx == INT32_MIN && sy == -1) ? 0 : sx % sy);
+                    break;
+                case Instruction::NOT: set(sx == 0); break;
+                case Instruction::EQ: set(sx == sy); break;
+                case Instruction::NEQ: set(sx != sy); break;
+                case Instruction::LT: set(sx < sy); break;
+                case Instruction::GT: set(sx > sy); break;
+                case Instruction::LE: set(sx <= sy); break;
+                case Instruction::GE: set(sx >= sy); break;
+                case Instruction::ASSIGN: set(x); break;
+                case Instruction::PARAM: pending.push_back(sx); break;
+                case Instruction::CALL: {
+                    std::vector<int32_t> call_args;
+                    call_args.swap(pending);
+                    const int32_t r = call(instr.arg1.name, call_args, depth + 1);
+                    if (is_value(instr.result)) set(r);
+                    break;
+                }
+                case Instruction::TAIL_CALL: {
+                    std::vector<int32_t> call_args;
+                    call_args.swap(pending);
+                    return call(instr.arg1.name, call_args, depth + 1);
+                }
+                case Instruction::RET: return sx;
+                case Instruction::JUMP:
+                    next = find_block(*func, instr.arg1.name);
+                    jumped = true;
+                    break;
+                case Instruction::JUMP_IF_ZERO: case Instruction::JUMP_IF_NZERO:
+                    if ((sx == 0) == (instr.opcode == Instruction::JUMP_IF_ZERO)) {
+                        next = find_block(*func, instr.arg2.name);
+                        jumped = true;
+                    }
+                    break;
+                case Instruction::LABEL: case Instruction::PHI: break;
+                }
+            }
+            prev = func->blocks[b].label;
+            b = next;
+        }
+        return fail("fell off the end of " + name.str());
+    }
+
+    bool ok() const { return m_ok; }
+    const std::string& error() const { return m_error; }
+
+private:
+    static const long kMaxSteps = 50000000;
+    static const int kMaxDepth = 10000;
+
+    int32_t fail(const std::string& message) {
+        if (m_ok) m_error = message;
+        m_ok = false;
+        return 0;
+    }
+
+    const ModuleIR& m_module;
+    long m_steps = 0;
+    bool m_ok = true;
+    std::string m_error;
+};
+
+struct Case {
+    const char* name;
+    const char* source;
+    int32_t expected;
+};
+
+const Case kCases[] = {
+    // i * 100000 在 i 约 21475 时越界：迭代次数不能跟着比较一起变
+    { "overflowing_scale_param",
+      "int f(int n) { int i = 0; int s = 0; while (i < n) { s = s + i * 100000; i = i + 1; } return s; }\n"
+      "int main() { if (f(30000) == 0) { return 1; } return 2; }\n",
+      2 },
+    { "overflowing_scale_const",
+      "int main() { int i = 0; int s = 0; while (i < 30000) { s = s + i * 100000; i = i + 1; } return s % 9973; }\n",
+      5354 },
+    // 负的乘数：比较方向反过来，同样不能越界
+    { "overflowing_negative_scale",
+      "int main() { int i = 0; int c = 0; while (i <= 25000) { c = c + 1; if (i * -90000 > 5) { c = c + 1000; } i = i + 1; } return c; }\n",
+      1165001 },
+    // 带 offset：i * 70000 + 2000000000 从一开始就越界
+    { "overflowing_offset",
+      "int main() { int i = 0; int c = 0; while (i < 100) { c = c + (i * 70000 + 2000000000) % 7; i = i + 1; } return c; }\n",
+      500 },
+    // 不越界的循环照常削弱，结果不变
+    { "in_range",
+      "int main() { int i = 0; int s = 0; while (i < 1000) { s = s + i * 12; i = i + 1; } return s % 997; }\n",
+      36 },
+    { "in_range_down",
+      "int main() { int i = 100; int s = 0; while (i > 0) { s = s + i * 7 - 3 * i; i = i - 2; } return s; }\n",
+      10200 },
+};
+
+// 编译到 IR；optimize 时按 -O2 优化
+bool build(const char* source, bool optimize, CompilationContext& ctx, ModuleIR& module) {
+    FILE* in = tmpfile();
+    if (!in) return false;
+    fputs(source, in);
+    rewind(in);
+    const bool parsed = ctx.parse(in);
+    fclose(in);
+    if (!parsed) return false;
+    SemanticAnalyzer analyzer(ctx);
+    analyzer.analyze(ctx.root());
+    if (!ctx.diagnostics().empty()) return false;
+    IRGenerator ir_gen;
+    module = ir_gen.generate(ctx.root());
+    ctx.releaseAst();
+    if (optimize) {
+        Optimizer optimizer(OptLevel::O2);
+        optimizer.run(module);
+    }
+    // 解释器按标签找块，-O0 时还没有建过控制流图
+    for (auto& func : module.functions) build_cfg(func);
+    return true;
+}
+
+int32_t run(const char* source, bool optimize, bool& ok, std::string& error) {
+    CompilationContext ctx;
+    ModuleIR module;
+    if (!build(source, optimize, ctx, module)) {
+        ok = false;
+        error = "compilation failed";
+        return 0;
+    }
+    Interpreter interp(module);
+    const int32_t result = interp.call(Symbol::intern("main"), {});
+    ok = interp.ok();
+    error = interp.error();
+    return result;
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    for (const Case& c : kCases) {
+        bool ok0, ok2;
+        std::string err0, err2;
+        const int32_t r0 = run(c.source, false, ok0, err0);
+        const int32_t r2 = run(c.source, true, ok2, err2);
+        const int32_t expected = c.expected;
+        if (!ok0 || !ok2 || r0 != expected || r2 != expected) {
+            ++failures;
+            std::cout << "FAIL " << c.name << ": expected " << expected << ", -O0 gave " << r0 << (ok0 ? "" : " (" + err0 + ")")
+                      << ", -O2 gave " << r2 << (ok2 ? "" : " (" + err2 + ")") << std::endl;
+        }
+    }
+    std::cout << "loop strength reduction: " << sizeof(kCases) / sizeof(kCases[0]) << " programs, " << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+// 常量乘除强度削弱的正确性测试
+//
+// 对每个常量调用 expand_mul/div/rem_by_constant，用一个只认识这几条指令的小解释器
+// 执行生成的序列，再和 RV32M 的 mul/div/rem 语义（向零取整，除以 0 和 INT_MIN / -1
+// 按规范给出的结果）逐个比较。除了结果，还检查除 rd、t1、t2 以外的寄存器没有被改写。
+// 全部通过时返回 0，否则打印出错的用例并返回 1。
+#include "StrengthReduction.hpp"
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+using MI = MachineInstr;
+
+enum class Op { Mul, Div, Rem };
+
+const char* op_name(Op op) {
+    switch (op) {
+    case Op::Mul: return "mul";
+    case Op::Div: return "div";
+    case Op::Rem: return "rem";
+    }
+    return "?";
+}
+
+// RV32M 的参考结果
+int32_t reference(Op op, int32_t n, int32_t d) {
+    switch (op) {
+    case Op::Mul:
+        return (int32_t)((uint32_t)n * (uint32_t)d);
+    case Op::Div:
+        if (d == 0) return -1;
+        if (n == INT32_MIN && d == -1) return INT32_MIN;
+        return n / d;
+    case Op::Rem:
+        if (d == 0) return n;
+        if (n == INT32_MIN && d == -1) return 0;
+        return n % d;
+    }
+    return 0;
+}
+
+// 执行一段序列；遇到解释器不认识的指令时返回 false
+bool run(const std::vector<MI>& seq, uint32_t regs[NUM_PHYS_REGS]) {
+    for (const MI& mi : seq) {
+        auto reg = [&](int i) { return regs[mi.ops[i].reg]; };
+        auto imm = [&](int i) { return mi.ops[i].value; };
+        uint32_t v = 0;
+        switch (mi.opcode) {
+        case MI::LI:   v = (uint32_t)imm(1); break;
+        case MI::MV:   v = reg(1); break;
+        case MI::NEG:  v = 0u - reg(1); break;
+        case MI::ADD:  v = reg(1) + reg(2); break;
+        case MI::SUB:  v = reg(1) - reg(2); break;
+        case MI::MUL:  v = reg(1) * reg(2); break;
+        case MI::MULH: v = (uint32_t)(((int64_t)(int32_t)reg(1) * (int64_t)(int32_t)reg(2)) >> 32); break;
+        case MI::ANDI: v = reg(1) & (uint32_t)imm(2); break;
+        case MI::SLLI: v = reg(1) << imm(2); break;
+        case MI::SRLI: v = reg(1) >> imm(2); break;
+        case MI::SRAI: v = (uint32_t)((int32_t)reg(1) >> imm(2)); break;
+        default:
+            std::printf("unexpected instruction %s\n", opcode_name(mi.opcode));
+            return false;
+        }
+        if (mi.ops[0].reg != ZERO) regs[mi.ops[0].reg] = v;
+    }
+    return true;
+}
+
+struct Registers {
+    PhysReg rd, rs, t1, t2;
+};
+
+// rd 可以和 rs、t1、t2 重合；t1、t2 与 rs 不同
+const Registers kRegisterChoices[] = {
+    { A1, A0, T0, T1 },
+    { A0, A0, T0, T1 },  // rd == rs
+    { T0, A0, T0, T1 },  // rd == t1
+    { T1, A0, T0, T1 },  // rd == t2
+};
+
+long g_cases = 0;
+long g_failures = 0;
+
+void check(Op op, int32_t c, const std::vector<int32_t>& dividends) {
+    for (const Registers& r : kRegisterChoices) {
+        std::vector<MI> seq;
+        bool expanded = false;
+        switch (op) {
+        case Op::Mul: expanded = expand_mul_by_constant(r.rd, r.rs, c, r.t1, r.t2, seq); break;
+        case Op::Div: expanded = expand_div_by_constant(r.rd, r.rs, c, r.t1, r.t2, seq); break;
+        case Op::Rem: expanded = expand_rem_by_constant(r.rd, r.rs, c, r.t1, r.t2, seq); break;
+        }
+        if (!expanded) {
+            // 不削弱时不能留下半截序列
+            if (!seq.empty()) {
+                std::printf("FAIL %s by %d: returned false but emitted %zu instructions\n", op_name(op), c, seq.size());
+                ++g_failures;
+            }
+            continue;
+        }
+        for (int32_t n : dividends) {
+            ++g_cases;
+            uint32_t regs[NUM_PHYS_REGS];
+            for (int i = 0; i < NUM_PHYS_REGS; ++i) regs[i] = 0x5A5A0000u + i;
+            regs[ZERO] = 0;
+            regs[r.rs] = (uint32_t)n;
+            uint32_t before[NUM_PHYS_REGS];
+            for (int i = 0; i < NUM_PHYS_REGS; ++i) before[i] = regs[i];
+
+            if (!run(seq, regs)) {
+                ++g_failures;
+                return;
+            }
+            const int32_t expected = reference(op, n, c);
+            bool ok = (int32_t)regs[r.rd] == expected;
+            for (int i = 0; i < NUM_PHYS_REGS; ++i) {
+                if (i == r.rd || i == r.t1 || i == r.t2) continue;
+                if (regs[i] != before[i]) ok = false;
+            }
+            if (!ok) {
+                ++g_failures;
+                if (g_failures <= 20) {
+                    std::printf("FAIL %s: %d %s %d = %d, sequence gave %d (rd=%s rs=%s)\n", op_name(op), n,
+                        op == Op::Mul ? "*" : (op == Op::Div ? "/" : "%"), c, expected, (int32_t)regs[r.rd],
+                        reg_name(r.rd), reg_name(r.rs));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(20240601);
+    auto random_int = [&]() { return (int32_t)rng(); };
+
+    // 常量：±1、±2^k、2^k±1 及其相反数、INT_MIN、INT_MAX、小整数，再加一些随机数
+    std::vector<int32_t> constants = { 0, 1, -1, INT32_MIN, INT32_MAX, INT32_MIN + 1 };
+    for (int k = 1; k <= 30; ++k) {
+        const int32_t p = (int32_t)1 << k;
+        for (int32_t c : { p, p - 1, p + 1 }) {
+            constants.push_back(c);
+            constants.push_back(-c);
+        }
+    }
+    for (int32_t c = -100; c <= 100; ++c) constants.push_back(c);
+    for (int i = 0; i < 200; ++i) constants.push_back(random_int());
+    for (int i = 0; i < 100; ++i) constants.push_back(random_int() % 100000);
+
+    // 被除数（被乘数）：边界值、小整数和随机数
+    std::vector<int32_t> base = { 0, 1, -1, 2, -2, INT32_MIN, INT32_MIN + 1, INT32_MAX, INT32_MAX - 1 };
+    for (int32_t n = -300; n <= 300; ++n) base.push_back(n);
+    for (int i = 0; i < 2000; ++i) base.push_back(random_int());
+
+    for (int32_t c : constants) {
+        // 常量附近的值最容易暴露取整错误
+        std::vector<int32_t> dividends = base;
+        for (int64_t m = -3; m <= 3; ++m) {
+            for (int64_t off = -1; off <= 1; ++off) {
+                const int64_t v = m * (int64_t)c + off;
+                if (v >= INT32_MIN && v <= INT32_MAX) dividends.push_back((int32_t)v);
+            }
+        }
+        check(Op::Mul, c, dividends);
+        check(Op::Div, c, dividends);
+        check(Op::Rem, c, dividends);
+    }
+
+    std::printf("strength reduction: %ld cases, %ld failures\n", g_cases, g_failures);
+    return g_failures == 0 ? 0 : 1;
+}